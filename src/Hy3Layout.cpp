@@ -12,21 +12,43 @@
 std::unique_ptr<HOOK_CALLBACK_FN> renderHookPtr =
     std::make_unique<HOOK_CALLBACK_FN>(Hy3Layout::renderHook);
 std::unique_ptr<HOOK_CALLBACK_FN> windowTitleHookPtr =
-    std::make_unique<HOOK_CALLBACK_FN>(Hy3Layout::windowGroupUpdateRecursiveHook);
+    std::make_unique<HOOK_CALLBACK_FN>(Hy3Layout::windowTitleHook);
 std::unique_ptr<HOOK_CALLBACK_FN> urgentHookPtr =
     std::make_unique<HOOK_CALLBACK_FN>(Hy3Layout::windowGroupUrgentHook);
 std::unique_ptr<HOOK_CALLBACK_FN> tickHookPtr =
     std::make_unique<HOOK_CALLBACK_FN>(Hy3Layout::tickHook);
-
-bool performContainment(Hy3Node& node, bool contained, CWindow* window) {
-	if (node.data.type == Hy3NodeType::Group) {
+std::unique_ptr<HOOK_CALLBACK_FN> closeWindowHookPtr =
+    std::make_unique<HOOK_CALLBACK_FN>(Hy3Layout::windowCloseHook);
+std::unique_ptr<HOOK_CALLBACK_FN> workspaceContextHookPtr =
+    std::make_unique<HOOK_CALLBACK_FN>(Hy3Layout::workspaceContextHook);
+std::unique_ptr<HOOK_CALLBACK_FN> monitorRemovedHookPtr =
+    std::make_unique<HOOK_CALLBACK_FN>(Hy3Layout::monitorRemovedHook);
+
+// events that can change which monitor a workspace is on or which rule applies to it
+const char* const WORKSPACE_CONTEXT_EVENTS[] = {
+    "workspace",
+    "createWorkspace",
+    "destroyWorkspace",
+    "moveWorkspace",
+    "monitorAdded",
+    "monitorRemoved",
+    "configReloaded",
+};
+
+bool performContainment(Hy3Node& root, bool contained, CWindow* window) {
+	// only the first child group of each group is searched, so this walks a single path
+	Hy3Node* next = &root;
+
+	while (next != nullptr && next->data.type == Hy3NodeType::Group) {
+		auto& node = *next;
 		auto& group = node.data.as_group;
 		contained |= group.containment;
+		next = nullptr;
 
 		auto iter = node.data.as_group.children.begin();
-		while (iter != node.data.as_group.children.end()) {
+		while (next == nullptr && iter != node.data.as_group.children.end()) {
 			switch ((*iter)->data.type) {
-			case Hy3NodeType::Group: return performContainment(**iter, contained, window);
+			case Hy3NodeType::Group: next = *iter; break;
 			case Hy3NodeType::Window:
 				if (contained) {
 					auto wpid = (*iter)->data.as_window->getPID();
@@ -101,7 +123,19 @@ void Hy3Layout::onWindowCreatedTiling(CWindow* window, eDirection) {
 	    .layout = this,
 	});
 
-	this->insertNode(this->nodes.back());
+	auto& node = this->nodes.back();
+	this->insertNode(node);
+
+	// A new window has no previous layout to stay consistent with, so its geometry is
+	// not held by the transaction its siblings are resized in.
+	this->commitWindowGeometry(window);
+
+	// The window has not been shown yet. Place it directly in its slot instead of
+	// animating it from whatever size the client picked for itself.
+	if (node.parent != nullptr && !window->m_bIsFullscreen) {
+		window->m_vRealPosition.warp();
+		window->m_vRealSize.warp();
+	}
 }
 
 void Hy3Layout::insertNode(Hy3Node& node) {
@@ -136,13 +170,19 @@ void Hy3Layout::insertNode(Hy3Node& node) {
 
 	auto* root = this->getWorkspaceRootGroup(node.workspace_id);
 
+	// Structural changes made while picking the target slot are not recalculated
+	// individually. The single recalculation once the node has been placed sends each
+	// affected window (including the new one) its final size in one configure.
 	if (root != nullptr) {
 		opening_after = root->getFocusedNode();
 
 		// opening_after->parent cannot be nullptr
 		if (opening_after == root) {
-			opening_after =
-			    opening_after->intoGroup(Hy3GroupLayout::SplitH, GroupEphemeralityOption::Standard);
+			opening_after = opening_after->intoGroup(
+			    Hy3GroupLayout::SplitH,
+			    GroupEphemeralityOption::Standard,
+			    false
+			);
 		}
 	}
 
@@ -254,7 +294,8 @@ void Hy3Layout::insertNode(Hy3Node& node) {
 			if (trigger >= 0 && (trigger == 0 || size_after_addition < trigger)) {
 				auto opening_after1 = opening_after->intoGroup(
 				    is_horizontal ? Hy3GroupLayout::SplitV : Hy3GroupLayout::SplitH,
-				    *at_ephemeral ? GroupEphemeralityOption::Ephemeral : GroupEphemeralityOption::Standard
+				    *at_ephemeral ? GroupEphemeralityOption::Ephemeral : GroupEphemeralityOption::Standard,
+				    false
 				);
 				opening_into = opening_after;
 				opening_after = opening_after1;
@@ -284,6 +325,11 @@ void Hy3Layout::insertNode(Hy3Node& node) {
 
 	node.markFocused();
 	opening_into->recalcSizePosRecursive();
+
+	// Bars above the target group may show a title that changed, either the new focus or
+	// a group created above without recalculating. The bar of the group itself, and all
+	// below it, were updated by the recalculation.
+	if (opening_into->parent != nullptr) opening_into->parent->updateTabBarRecursive();
 }
 
 void Hy3Layout::onWindowRemovedTiling(CWindow* window) {
@@ -306,10 +352,18 @@ void Hy3Layout::onWindowRemovedTiling(CWindow* window) {
 	window->m_sSpecialRenderData.border = true;
 	window->m_sSpecialRenderData.decorate = true;
 
+	std::erase_if(this->transaction.windows, [window](auto& pending) {
+		return pending.window == window;
+	});
+
+	std::erase(this->title_updates.windows, window);
+
 	if (window->m_bIsFullscreen) {
 		g_pCompositor->setWindowFullscreen(window, false, FULLSCREEN_FULL);
 	}
 
+	this->scheduleCompaction(node->workspace_id);
+
 	Hy3Node* expand_actor = nullptr;
 	auto* parent = node->removeFromParentRecursive(&expand_actor);
 	this->nodes.remove(*node);
@@ -367,28 +421,47 @@ void Hy3Layout::recalculateMonitor(const int& monitor_id) {
 	const auto monitor = g_pCompositor->getMonitorFromID(monitor_id);
 	if (monitor == nullptr) return;
 
+	this->invalidateWorkspaceContexts();
+
 	g_pHyprRenderer->damageMonitor(monitor);
 
-	// todo: refactor this
+	// if the monitor itself did not change, only its reserved area (e.g. a bar being
+	// shown or hidden) did, and the already solved geometry can be shifted instead.
+	auto last_box = this->monitor_boxes.find(monitor_id);
+	bool reserved_only = last_box != this->monitor_boxes.end()
+	                  && last_box->second.position == monitor->vecPosition
+	                  && last_box->second.size == monitor->vecSize;
 
-	auto* top_node = this->getWorkspaceRootGroup(monitor->activeWorkspace);
-	if (top_node != nullptr) {
-		top_node->position = monitor->vecPosition + monitor->vecReservedTopLeft;
-		top_node->size =
-		    monitor->vecSize - monitor->vecReservedTopLeft - monitor->vecReservedBottomRight;
+	this->monitor_boxes[monitor_id] = {monitor->vecPosition, monitor->vecSize};
 
-		top_node->recalcSizePosRecursive();
-	}
+	auto* top_node = this->getWorkspaceRootGroup(monitor->activeWorkspace);
+	if (top_node != nullptr) this->recalculateWorkspaceRoot(top_node, monitor, reserved_only);
 
 	top_node = this->getWorkspaceRootGroup(monitor->specialWorkspaceID);
+	if (top_node != nullptr) this->recalculateWorkspaceRoot(top_node, monitor, reserved_only);
+}
 
-	if (top_node != nullptr) {
-		top_node->position = monitor->vecPosition + monitor->vecReservedTopLeft;
-		top_node->size =
-		    monitor->vecSize - monitor->vecReservedTopLeft - monitor->vecReservedBottomRight;
+void Hy3Layout::recalculateWorkspaceRoot(Hy3Node* root, CMonitor* monitor, bool reserved_only) {
+	auto position = monitor->vecPosition + monitor->vecReservedTopLeft;
+	auto size = monitor->vecSize - monitor->vecReservedTopLeft - monitor->vecReservedBottomRight;
 
-		top_node->recalcSizePosRecursive();
+	auto topleft_delta = position - root->position;
+	auto bottomright_delta = (position + size) - (root->position + root->size);
+
+	// a zero delta means something other than the reserved area changed (config
+	// reload, fullscreen, etc), which requires a full recalculation.
+	if (reserved_only && (topleft_delta != Vector2D() || bottomright_delta != Vector2D())) {
+		if (root->moveEdgesRecursive(topleft_delta, bottomright_delta)) {
+			hy3_log(TRACE, "shifted edges of root node {:x} instead of recalculating", (uintptr_t) root);
+			return;
+		}
+
+		hy3_log(TRACE, "edges of root node {:x} cannot be shifted exactly", (uintptr_t) root);
 	}
+
+	root->position = position;
+	root->size = size;
+	root->recalcSizePosRecursive();
 }
 
 void Hy3Layout::recalculateWindow(CWindow* window) {
@@ -507,9 +580,17 @@ void Hy3Layout::fullscreenRequestForWindow(
 	const auto workspace = g_pCompositor->getWorkspaceByID(window->m_iWorkspaceID);
 	if (workspace->m_bHasFullscreenWindow && on) return;
 
+	// a held tiled geometry would otherwise be read below, or replace the fullscreen one later
+	this->commitWindowGeometry(window);
+
 	window->m_bIsFullscreen = on;
 	workspace->m_bHasFullscreenWindow = !workspace->m_bHasFullscreenWindow;
 
+	// tab bars fade out under fullscreen windows
+	for (auto& group: this->tab_groups) {
+		if (group.workspace_id == window->m_iWorkspaceID) this->wakeTabGroup(&group);
+	}
+
 	if (!window->m_bIsFullscreen) {
 		auto* node = this->getNodeFromWindow(window);
 
@@ -572,6 +653,9 @@ void Hy3Layout::fullscreenRequestForWindow(
 		}
 	}
 
+	// the window's geometry is used directly below
+	this->commitWindowGeometry(window);
+
 	g_pCompositor->updateWindowAnimatedDecorationValues(window);
 	g_pXWaylandManager->setWindowSize(window, window->m_vRealSize.goal());
 	g_pCompositor->changeWindowZOrder(window, true);
@@ -675,6 +759,8 @@ void Hy3Layout::bringWindowToTop(CWindow* window) {
 }
 
 void Hy3Layout::onEnable() {
+	this->ticking.enabled = true;
+
 	for (auto& window: g_pCompositor->m_vWindows) {
 		if (window->isHidden() || !window->m_bIsMapped || window->m_bFadingOut || window->m_bIsFloating)
 			continue;
@@ -685,7 +771,14 @@ void Hy3Layout::onEnable() {
 	HyprlandAPI::registerCallbackStatic(PHANDLE, "render", renderHookPtr.get());
 	HyprlandAPI::registerCallbackStatic(PHANDLE, "windowTitle", windowTitleHookPtr.get());
 	HyprlandAPI::registerCallbackStatic(PHANDLE, "urgent", urgentHookPtr.get());
-	HyprlandAPI::registerCallbackStatic(PHANDLE, "tick", tickHookPtr.get());
+	HyprlandAPI::registerCallbackStatic(PHANDLE, "closeWindow", closeWindowHookPtr.get());
+
+	for (auto* event: WORKSPACE_CONTEXT_EVENTS) {
+		HyprlandAPI::registerCallbackStatic(PHANDLE, event, workspaceContextHookPtr.get());
+	}
+
+	HyprlandAPI::registerCallbackStatic(PHANDLE, "monitorRemoved", monitorRemovedHookPtr.get());
+
 	selection_hook::enable();
 }
 
@@ -693,9 +786,28 @@ void Hy3Layout::onDisable() {
 	HyprlandAPI::unregisterCallback(PHANDLE, renderHookPtr.get());
 	HyprlandAPI::unregisterCallback(PHANDLE, windowTitleHookPtr.get());
 	HyprlandAPI::unregisterCallback(PHANDLE, urgentHookPtr.get());
-	HyprlandAPI::unregisterCallback(PHANDLE, tickHookPtr.get());
+	HyprlandAPI::unregisterCallback(PHANDLE, closeWindowHookPtr.get());
+	HyprlandAPI::unregisterCallback(PHANDLE, workspaceContextHookPtr.get());
+	HyprlandAPI::unregisterCallback(PHANDLE, monitorRemovedHookPtr.get());
 	selection_hook::disable();
 
+	this->invalidateWorkspaceContexts();
+	this->monitor_boxes.clear();
+
+	this->commitTransaction();
+	this->title_updates.windows.clear();
+
+	if (this->compaction.idle_source != nullptr) {
+		wl_event_source_remove(this->compaction.idle_source);
+		this->compaction.idle_source = nullptr;
+	}
+
+	this->compaction.workspaces.clear();
+
+	// Tab groups still wake themselves while being destroyed below, or from animations
+	// finishing later, which must not register the tick hook again.
+	this->ticking.enabled = false;
+
 	for (auto& node: this->nodes) {
 		if (node.data.type == Hy3NodeType::Window) {
 			node.data.as_window->setHidden(false);
@@ -703,6 +815,26 @@ void Hy3Layout::onDisable() {
 	}
 
 	this->nodes.clear();
+
+	if (this->ticking.registered) {
+		HyprlandAPI::unregisterCallback(PHANDLE, tickHookPtr.get());
+		this->ticking.registered = false;
+	}
+
+	if (this->ticking.idle_source != nullptr) {
+		wl_event_source_remove(this->ticking.idle_source);
+		this->ticking.idle_source = nullptr;
+	}
+
+	for (auto* group: this->ticking.groups) {
+		group->ticking = false;
+	}
+
+	this->ticking.groups.clear();
+
+	// groups of the destroyed nodes would never be ticked, and so removed, again
+	this->tab_group_targets.clear();
+	this->tab_groups.clear();
 }
 
 void Hy3Layout::makeGroupOnWorkspace(
@@ -724,6 +856,7 @@ void Hy3Layout::changeGroupOnWorkspace(int workspace, Hy3GroupLayout layout) {
 	if (node == nullptr) return;
 
 	this->changeGroupOn(*node, layout);
+	this->scheduleCompaction(workspace);
 }
 
 void Hy3Layout::untabGroupOnWorkspace(int workspace) {
@@ -745,6 +878,7 @@ void Hy3Layout::changeGroupToOppositeOnWorkspace(int workspace) {
 	if (node == nullptr) return;
 
 	this->changeGroupToOppositeOn(*node);
+	this->scheduleCompaction(workspace);
 }
 
 void Hy3Layout::changeGroupEphemeralityOnWorkspace(int workspace, bool ephemeral) {
@@ -766,13 +900,16 @@ void Hy3Layout::makeGroupOn(
 		if (group.children.size() == 1) {
 			group.setLayout(layout);
 			group.setEphemeral(ephemeral);
+			group.user_created = true;
 			node->parent->updateTabBarRecursive();
 			node->parent->recalcSizePosRecursive();
 			return;
 		}
 	}
 
+	// node becomes the new group
 	node->intoGroup(layout, ephemeral);
+	node->data.as_group.user_created = true;
 }
 
 void Hy3Layout::makeOppositeGroupOn(Hy3Node* node, GroupEphemeralityOption ephemeral) {
@@ -780,6 +917,7 @@ void Hy3Layout::makeOppositeGroupOn(Hy3Node* node, GroupEphemeralityOption ephem
 
 	if (node->parent == nullptr) {
 		node->intoGroup(Hy3GroupLayout::SplitH, ephemeral);
+		node->data.as_group.user_created = true;
 		return;
 	}
 
@@ -790,11 +928,13 @@ void Hy3Layout::makeOppositeGroupOn(Hy3Node* node, GroupEphemeralityOption ephem
 	if (group.children.size() == 1) {
 		group.setLayout(layout);
 		group.setEphemeral(ephemeral);
+		group.user_created = true;
 		node->parent->recalcSizePosRecursive();
 		return;
 	}
 
 	node->intoGroup(layout, ephemeral);
+	node->data.as_group.user_created = true;
 }
 
 void Hy3Layout::changeGroupOn(Hy3Node& node, Hy3GroupLayout layout) {
@@ -851,6 +991,133 @@ void Hy3Layout::changeGroupEphemeralityOn(Hy3Node& node, bool ephemeral) {
 	);
 }
 
+void Hy3Layout::compactWorkspace(int workspace) {
+	static const auto node_collapse_policy =
+	    ConfigValue<Hyprlang::INT>("plugin:hy3:node_collapse_policy");
+
+	auto* root = this->getWorkspaceRootGroup(workspace);
+	if (root == nullptr) return;
+
+	// a selected group is left alone so the selection does not change
+	auto* focused = this->getWorkspaceFocusedNode(workspace);
+
+	std::vector<Hy3Node*> groups;
+	std::vector<Hy3Node*> stack = {root};
+
+	while (!stack.empty()) {
+		auto* node = stack.back();
+		stack.pop_back();
+
+		if (node->data.type != Hy3NodeType::Group) continue;
+		groups.push_back(node);
+
+		auto& children = node->data.as_group.children;
+		stack.insert(stack.end(), children.begin(), children.end());
+	}
+
+	// groups whose identity matters and must not be collapsed or flattened away
+	auto is_fixed = [&](Hy3Node* node) {
+		auto& group = node->data.as_group;
+		return node == focused || group.expand_focused != ExpandFocusType::NotExpanded
+		    || group.containment || group.user_created
+		    || (node->parent != nullptr
+		        && node->parent->data.as_group.expand_focused != ExpandFocusType::NotExpanded);
+	};
+
+	bool changed = false;
+
+	// children first, so chains are folded from the bottom up
+	for (auto iter = groups.rbegin(); iter != groups.rend(); iter++) {
+		auto* node = *iter;
+		auto& group = node->data.as_group;
+		if (is_fixed(node)) continue;
+
+		// Single child groups holding another group, mirroring removal with
+		// node_collapse_policy. The child's node is replaced as well, so it must not be
+		// fixed either.
+		if (group.children.size() == 1 && group.children.front()->data.type == Hy3NodeType::Group
+		    && !is_fixed(group.children.front())
+		    && (*node_collapse_policy == 0
+		        || (*node_collapse_policy == 2 && group.layout != Hy3GroupLayout::Tabbed)))
+		{
+			hy3_log(TRACE, "compaction: collapsing single child group {:x}", (uintptr_t) node);
+			if (!Hy3Node::swallowGroups(node)) continue;
+			changed = true;
+
+			// node now holds the data of its former child
+			if (is_fixed(node)) continue;
+		}
+
+		auto* parent = node->parent;
+		if (parent == nullptr) continue;
+		auto& parent_group = parent->data.as_group;
+
+		if (group.layout == Hy3GroupLayout::Tabbed || group.layout != parent_group.layout
+		    || group.children.size() < 2)
+			continue;
+
+		hy3_log(
+		    TRACE,
+		    "compaction: flattening group {:x} into group {:x}",
+		    (uintptr_t) node,
+		    (uintptr_t) parent
+		);
+
+		// Rescale ratios so every node keeps its size in the parent, which now
+		// divides its space between n - 1 + m children instead of n.
+		double n = parent_group.children.size();
+		double m = group.children.size();
+		double scale = (n - 1 + m) / n;
+
+		for (auto* sibling: parent_group.children) {
+			if (sibling != node) sibling->size_ratio *= scale;
+		}
+
+		for (auto* child: group.children) {
+			child->size_ratio *= node->size_ratio * scale / m;
+			child->parent = parent;
+		}
+
+		if (parent_group.focused_child == node) {
+			parent_group.focused_child =
+			    group.focused_child != nullptr ? group.focused_child : group.children.front();
+		}
+
+		auto position = std::find(parent_group.children.begin(), parent_group.children.end(), node);
+		parent_group.children.splice(position, group.children);
+		parent_group.children.erase(position);
+		this->nodes.remove(*node);
+		changed = true;
+	}
+
+	if (changed) root->recalcSizePosRecursive();
+}
+
+void Hy3Layout::scheduleCompaction(int workspace) {
+	static const auto auto_compact = ConfigValue<Hyprlang::INT>("plugin:hy3:auto_compact");
+	if (!*auto_compact) return;
+
+	this->compaction.workspaces.insert(workspace);
+
+	// deferred so structural operations never see their nodes disappear mid-way
+	if (this->compaction.idle_source == nullptr) {
+		this->compaction.idle_source =
+		    wl_event_loop_add_idle(g_pCompositor->m_sWLEventLoop, &Hy3Layout::compactionIdle, this);
+	}
+}
+
+void Hy3Layout::compactionIdle(void* data) {
+	auto* layout = static_cast<Hy3Layout*>(data);
+	layout->compaction.idle_source = nullptr;
+
+	auto workspaces = std::move(layout->compaction.workspaces);
+	layout->compaction.workspaces.clear();
+
+	for (auto workspace: workspaces) {
+		layout->compactWorkspace(workspace);
+	}
+}
+
 void Hy3Layout::shiftNode(Hy3Node& node, ShiftDirection direction, bool once, bool visible) {
 	if (once && node.parent != nullptr && node.parent->data.as_group.children.size() == 1) {
 		if (node.parent->parent == nullptr) {
@@ -873,6 +1140,7 @@ void Hy3Layout::shiftWindow(int workspace, ShiftDirection direction, bool once,
 	if (node == nullptr) return;
 
 	this->shiftNode(*node, direction, once, visible);
+	this->scheduleCompaction(workspace);
 }
 
 void Hy3Layout::shiftFocus(int workspace, ShiftDirection direction, bool visible) {
@@ -978,6 +1246,9 @@ void Hy3Layout::moveNodeToWorkspace(int origin, std::string wsname, bool follow)
 
 		changeNodeWorkspaceRecursive(*node, workspace);
 		this->insertNode(*node);
+
+		this->scheduleCompaction(wsid);
+		this->scheduleCompaction(workspace->m_iID);
 	}
 
 	if (follow) {
@@ -1089,6 +1360,9 @@ Hy3Node* findTabBarAt(Hy3Node& node, Vector2D pos, Hy3Node** focused_node) {
 				auto x = pos.x - tab_bar.pos.value().x;
 				auto child_iter = children.begin();
 
+				// entries are laid out along a strip that may be scrolled
+				x += tab_bar.bar.scroll.value() * size.x;
+
 				for (auto& tab: tab_bar.bar.entries) {
 					if (child_iter == children.end()) break;
 
@@ -1304,6 +1578,8 @@ fullscreen:
 
 	if (workspace->m_bHasFullscreenWindow) return;
 
+	this->commitWindowGeometry(window);
+
 	window->m_bIsFullscreen = true;
 	workspace->m_bHasFullscreenWindow = true;
 	workspace->m_efFullscreenMode = FULLSCREEN_FULL;
@@ -1356,6 +1632,45 @@ Hy3Node* Hy3Layout::getWorkspaceRootGroup(const int& workspace) {
 	return nullptr;
 }
 
+Hy3Layout::WorkspaceContext* Hy3Layout::getWorkspaceContext(int workspace_id) {
+	auto entry = this->workspace_contexts.find(workspace_id);
+
+	if (entry != this->workspace_contexts.end()) {
+		auto& context = entry->second;
+
+		// special workspaces can be moved between monitors without an event
+		if (!context.special || context.monitor == nullptr
+		    || context.monitor->specialWorkspaceID == workspace_id)
+			return &context;
+
+		this->workspace_contexts.erase(entry);
+	}
+
+	auto* workspace = g_pCompositor->getWorkspaceByID(workspace_id);
+	if (workspace == nullptr) return nullptr;
+
+	WorkspaceContext context = {
+	    .workspace = workspace,
+	    .special = workspace->m_bIsSpecialWorkspace,
+	    .rule = g_pConfigManager->getWorkspaceRuleFor(workspace),
+	};
+
+	if (context.special) {
+		for (auto& m: g_pCompositor->m_vMonitors) {
+			if (m->specialWorkspaceID == workspace_id) {
+				context.monitor = m.get();
+				break;
+			}
+		}
+	} else {
+		context.monitor = g_pCompositor->getMonitorFromID(workspace->m_iMonitorID);
+	}
+
+	return &this->workspace_contexts.emplace(workspace_id, context).first->second;
+}
+
+void Hy3Layout::invalidateWorkspaceContexts() { this->workspace_contexts.clear(); }
+
 Hy3Node* Hy3Layout::getWorkspaceFocusedNode(
     const int& workspace,
     bool ignore_group_focus,
@@ -1368,37 +1683,43 @@ Hy3Node* Hy3Layout::getWorkspaceFocusedNode(
 
 void Hy3Layout::renderHook(void*, SCallbackInfo&, std::any data) {
 	static bool rendering_normally = false;
-	static std::vector<Hy3TabGroup*> rendered_groups;
+	// bumped for every monitor frame, groups drawn in it carry the same serial
+	static uint64_t frame = 0;
 
 	auto render_stage = std::any_cast<eRenderStage>(data);
 
 	switch (render_stage) {
+	case RENDER_PRE:
+		// The tick hook no longer runs every frame, and changes made with hyprctl keyword
+		// (e.g. workspace rules) emit no event, so contexts are refreshed once per frame here.
+		g_Hy3Layout->invalidateWorkspaceContexts();
+		break;
 	case RENDER_PRE_WINDOWS:
 		rendering_normally = true;
-		rendered_groups.clear();
+		frame++;
 		break;
-	case RENDER_POST_WINDOW:
+	case RENDER_POST_WINDOW: {
 		if (!rendering_normally) break;
 
-		for (auto& entry: g_Hy3Layout->tab_groups) {
-			if (!entry.hidden && entry.target_window == g_pHyprOpenGL->m_pCurrentWindow
-			    && std::find(rendered_groups.begin(), rendered_groups.end(), &entry)
-			           == rendered_groups.end())
-			{
+		auto [begin, end] =
+		    g_Hy3Layout->tab_group_targets.equal_range(g_pHyprOpenGL->m_pCurrentWindow);
+
+		for (auto iter = begin; iter != end; iter++) {
+			auto& entry = *iter->second;
+
+			if (!entry.hidden && !entry.suspended && entry.rendered_frame != frame) {
 				entry.renderTabBar();
-				rendered_groups.push_back(&entry);
+				entry.rendered_frame = frame;
 			}
 		}
-
-		break;
+	} break;
 	case RENDER_POST_WINDOWS:
 		rendering_normally = false;
 
 		for (auto& entry: g_Hy3Layout->tab_groups) {
-			if (!entry.hidden
+			if (!entry.hidden && !entry.suspended && entry.target_window != nullptr
 			    && entry.target_window->m_iMonitorID == g_pHyprOpenGL->m_RenderData.pMonitor->ID
-			    && std::find(rendered_groups.begin(), rendered_groups.end(), &entry)
-			           == rendered_groups.end())
+			    && entry.rendered_frame != frame)
 			{
 				entry.renderTabBar();
 			}
@@ -1426,14 +1747,162 @@ void Hy3Layout::windowGroupUpdateRecursiveHook(void*, SCallbackInfo&, std::any d
 	node->updateTabBarRecursive();
 }
 
+void Hy3Layout::windowTitleHook(void*, SCallbackInfo&, std::any data) {
+	CWindow* window = std::any_cast<CWindow*>(data);
+	if (window == nullptr) return;
+
+	// titles can change many times a frame, only the last one is shown
+	auto& windows = g_Hy3Layout->title_updates.windows;
+	if (std::find(windows.begin(), windows.end(), window) == windows.end()) {
+		windows.push_back(window);
+		g_Hy3Layout->updateTickRegistration();
+	}
+}
+
+void Hy3Layout::windowCloseHook(void*, SCallbackInfo&, std::any data) {
+	CWindow* window = std::any_cast<CWindow*>(data);
+	if (window == nullptr) return;
+
+	std::erase(g_Hy3Layout->title_updates.windows, window);
+
+	// Tab groups keep raw window pointers around for rendering. Dropping them here means
+	// every window they hold is known to be alive, without scanning the compositor's list.
+	for (auto& entry: g_Hy3Layout->tab_groups) {
+		entry.forgetWindow(window);
+	}
+}
+
+void Hy3Layout::workspaceContextHook(void*, SCallbackInfo&, std::any) {
+	g_Hy3Layout->invalidateWorkspaceContexts();
+	g_Hy3Layout->updateTabGroupVisibility();
+}
+
+void Hy3Layout::monitorRemovedHook(void*, SCallbackInfo&, std::any data) {
+	auto* monitor = std::any_cast<CMonitor*>(data);
+
+	// ids are reused, a later monitor must not be shifted against this one's box
+	g_Hy3Layout->monitor_boxes.erase(monitor->ID);
+}
+
+void Hy3Layout::updateTabGroupVisibility() {
+	for (auto& node: this->nodes) {
+		if (node.data.type != Hy3NodeType::Group) continue;
+
+		auto* tab_bar = node.data.as_group.tab_bar;
+		if (tab_bar == nullptr) continue;
+
+		if (!tab_bar->suspended) {
+			this->wakeTabGroup(tab_bar);
+		} else if (tab_bar->isVisible()) {
+			node.updateTabBar(true);
+		}
+	}
+}
+
 void Hy3Layout::tickHook(void*, SCallbackInfo&, std::any) {
-	auto& tab_groups = g_Hy3Layout->tab_groups;
-	auto entry = tab_groups.begin();
-	while (entry != tab_groups.end()) {
-		entry->tick();
-		if (entry->bar.destroy) tab_groups.erase(entry++);
-		else entry = std::next(entry);
+	auto* layout = g_Hy3Layout.get();
+
+	layout->invalidateWorkspaceContexts();
+	layout->updateTransaction();
+	layout->flushTitleUpdates();
+
+	// groups woken while ticking are visited on the next tick
+	auto groups = std::move(layout->ticking.groups);
+	layout->ticking.groups.clear();
+
+	for (auto* group: groups) {
+		group->ticking = false;
+	}
+
+	for (auto* group: groups) {
+		if (group->tick()) layout->wakeTabGroup(group);
+
+		if (group->bar.destroy) {
+			group->setTargetWindow(nullptr);
+			std::erase(layout->ticking.groups, group);
+			layout->tab_groups.remove_if([group](auto& entry) { return &entry == group; });
+		}
+	}
+
+	layout->updateTickRegistration();
+}
+
+void Hy3Layout::wakeTabGroup(Hy3TabGroup* group) {
+	if (!this->ticking.enabled || group->ticking) return;
+	group->ticking = true;
+	this->ticking.groups.push_back(group);
+	this->updateTickRegistration();
+}
+
+bool Hy3Layout::tickNeeded() {
+	return !this->ticking.groups.empty() || !this->transaction.windows.empty()
+	    || !this->title_updates.windows.empty();
+}
+
+void Hy3Layout::updateTickRegistration() {
+	if (!this->ticking.enabled) return;
+
+	if (this->tickNeeded() == this->ticking.registered || this->ticking.idle_source != nullptr)
+		return;
+
+	// hooks cannot be changed while an event, possibly the tick itself, is being emitted
+	this->ticking.idle_source = wl_event_loop_add_idle(
+	    g_pCompositor->m_sWLEventLoop,
+	    &Hy3Layout::tickRegistrationIdle,
+	    this
+	);
+}
+
+void Hy3Layout::tickRegistrationIdle(void* data) {
+	auto* layout = static_cast<Hy3Layout*>(data);
+	layout->ticking.idle_source = nullptr;
+
+	auto needed = layout->tickNeeded();
+	if (needed == layout->ticking.registered) return;
+
+	if (needed) {
+		HyprlandAPI::registerCallbackStatic(PHANDLE, "tick", tickHookPtr.get());
+	} else {
+		HyprlandAPI::unregisterCallback(PHANDLE, tickHookPtr.get());
 	}
+
+	layout->ticking.registered = needed;
+}
+
+void Hy3Layout::flushTitleUpdates() {
+	static const auto title_rate = ConfigValue<Hyprlang::INT>("plugin:hy3:tabs:title_rate");
+
+	if (this->title_updates.windows.empty()) return;
+
+	auto now = std::chrono::steady_clock::now();
+	auto since_flush = now - this->title_updates.last_flush;
+	if (*title_rate > 0 && since_flush < std::chrono::milliseconds(1000) / *title_rate) return;
+
+	this->title_updates.last_flush = now;
+
+	for (auto* window: this->title_updates.windows) {
+		auto* node = this->getNodeFromWindow(window);
+
+		// A node's title only shows in its parent's tab bar, and in the bars above that
+		// for as long as it is the focused child of each group.
+		while (node != nullptr && node->parent != nullptr) {
+			auto& group = node->parent->data.as_group;
+
+			if (group.tab_bar != nullptr) {
+				for (auto& entry: group.tab_bar->bar.entries) {
+					if (entry == *node) {
+						entry.setWindowTitle(node->getTitle());
+						break;
+					}
+				}
+			}
+
+			if (group.focused_child != node) break;
+			node = node->parent;
+		}
+	}
+
+	this->title_updates.windows.clear();
 }
 
 Hy3Node* Hy3Layout::getNodeFromWindow(CWindow* window) {
@@ -1449,24 +1918,15 @@ Hy3Node* Hy3Layout::getNodeFromWindow(CWindow* window) {
 void Hy3Layout::applyNodeDataToWindow(Hy3Node* node, bool no_animation) {
 	if (node->data.type != Hy3NodeType::Window) return;
 	auto* window = node->data.as_window;
-	auto root_node = this->getWorkspaceRootGroup(window->m_iWorkspaceID);
 
-	CMonitor* monitor = nullptr;
+	// fullscreen windows are applied through a detached copy of their node
+	auto* root_node = node;
+	while (root_node->parent != nullptr) root_node = root_node->parent;
+	if (root_node == node) root_node = this->getWorkspaceRootGroup(window->m_iWorkspaceID);
 
-	auto* workspace = g_pCompositor->getWorkspaceByID(node->workspace_id);
+	auto* context = this->getWorkspaceContext(node->workspace_id);
 
-	if (g_pCompositor->isWorkspaceSpecial(node->workspace_id)) {
-		for (auto& m: g_pCompositor->m_vMonitors) {
-			if (m->specialWorkspaceID == node->workspace_id) {
-				monitor = m.get();
-				break;
-			}
-		}
-	} else {
-		monitor = g_pCompositor->getMonitorFromID(workspace->m_iMonitorID);
-	}
-
-	if (monitor == nullptr) {
+	if (context == nullptr || context->monitor == nullptr) {
 		hy3_log(
 		    ERR,
 		    "node {:x}'s workspace has no associated monitor, cannot apply node data",
@@ -1476,14 +1936,15 @@ void Hy3Layout::applyNodeDataToWindow(Hy3Node* node, bool no_animation) {
 		return;
 	}
 
-	const auto workspace_rule = g_pConfigManager->getWorkspaceRuleFor(workspace);
+	const auto& workspace_rule = context->rule;
 
 	// clang-format off
 	static const auto gaps_in = ConfigValue<Hyprlang::CUSTOMTYPE, CCssGapData>("general:gaps_in");
 	static const auto no_gaps_when_only = ConfigValue<Hyprlang::INT>("plugin:hy3:no_gaps_when_only");
 	// clang-format on
 
-	if (!g_pCompositor->windowExists(window) || !window->m_bIsMapped) {
+	// windows are removed from the tree when unmapped, before they can be destroyed
+	if (!window->m_bIsMapped) {
 		hy3_log(
 		    ERR,
 		    "node {:x} is an unmapped window ({:x}), cannot apply node data, removing from tiled "
@@ -1507,11 +1968,14 @@ void Hy3Layout::applyNodeDataToWindow(Hy3Node* node, bool no_animation) {
 	auto only_node = root_node != nullptr && root_node->data.as_group.children.size() == 1
 	              && root_node->data.as_group.children.front()->data.type == Hy3NodeType::Window;
 
-	if (!g_pCompositor->isWorkspaceSpecial(window->m_iWorkspaceID)
+	Vector2D position;
+	Vector2D size;
+	bool no_gaps = false;
+
+	if (!context->special
 	    && ((*no_gaps_when_only != 0 && (only_node || window->m_bIsFullscreen))
 	        || (window->m_bIsFullscreen
-	            && g_pCompositor->getWorkspaceByID(window->m_iWorkspaceID)->m_efFullscreenMode
-	                   == FULLSCREEN_FULL)))
+	            && context->workspace->m_efFullscreenMode == FULLSCREEN_FULL)))
 	{
 		window->m_sSpecialRenderData.border = workspace_rule.border.value_or(*no_gaps_when_only == 2);
 		window->m_sSpecialRenderData.rounding = false;
@@ -1521,10 +1985,9 @@ void Hy3Layout::applyNodeDataToWindow(Hy3Node* node, bool no_animation) {
 
 		const auto reserved = window->getFullWindowReservedArea();
 
-		window->m_vRealPosition = window->m_vPosition + reserved.topLeft;
-		window->m_vRealSize = window->m_vSize - (reserved.topLeft + reserved.bottomRight);
-
-		g_pXWaylandManager->setWindowSize(window, window->m_vRealSize.goal());
+		position = window->m_vPosition + reserved.topLeft;
+		size = window->m_vSize - (reserved.topLeft + reserved.bottomRight);
+		no_gaps = true;
 	} else {
 		auto calcPos = window->m_vPosition;
 		auto calcSize = window->m_vSize;
@@ -1544,24 +2007,157 @@ void Hy3Layout::applyNodeDataToWindow(Hy3Node* node, bool no_animation) {
 		CBox wb = {calcPos, calcSize};
 		wb.round();
 
-		window->m_vRealPosition = wb.pos();
-		window->m_vRealSize = wb.size();
+		position = wb.pos();
+		size = wb.size();
+	}
 
-		g_pXWaylandManager->setWindowSize(window, wb.size());
+	g_pXWaylandManager->setWindowSize(window, size);
 
-		if (no_animation) {
-			g_pHyprRenderer->damageWindow(window);
+	static const auto transactions = ConfigValue<Hyprlang::INT>("plugin:hy3:transactions:enable");
 
-			window->m_vRealPosition.warp();
-			window->m_vRealSize.warp();
+	if (!*transactions) {
+		this->setWindowGeometry(window, position, size, no_animation, no_gaps);
+		return;
+	}
 
-			g_pHyprRenderer->damageWindow(window);
-		}
+	// hold the new geometry until every window in the transaction has committed a
+	// buffer for it, so the whole layout change is presented in one frame.
+	if (this->transaction.windows.empty()) {
+		this->transaction.started = std::chrono::steady_clock::now();
+	}
 
-		window->updateWindowDecos();
+	auto pending = std::find_if(
+	    this->transaction.windows.begin(),
+	    this->transaction.windows.end(),
+	    [window](auto& pending) { return pending.window == window; }
+	);
+
+	if (pending == this->transaction.windows.end()) {
+		this->transaction.windows.push_back({
+		    .window = window,
+		    .position = position,
+		    .size = size,
+		    .no_animation = no_animation,
+		    .no_gaps = no_gaps,
+		});
+
+		this->updateTickRegistration();
+	} else {
+		pending->position = position;
+		pending->size = size;
+		pending->no_animation = no_animation;
+		pending->no_gaps = no_gaps;
 	}
 }
 
+void Hy3Layout::setWindowGeometry(
+    CWindow* window,
+    Vector2D position,
+    Vector2D size,
+    bool no_animation,
+    bool no_gaps
+) {
+	window->m_vRealPosition = position;
+	window->m_vRealSize = size;
+
+	// decorations were already updated for the gapless state
+	if (no_gaps) return;
+
+	if (no_animation) {
+		g_pHyprRenderer->damageWindow(window);
+
+		window->m_vRealPosition.warp();
+		window->m_vRealSize.warp();
+
+		g_pHyprRenderer->damageWindow(window);
+	}
+
+	window->updateWindowDecos();
+}
+
+void Hy3Layout::commitTransaction() {
+	if (this->transaction.windows.empty()) return;
+
+	hy3_log(TRACE, "committing transaction of {} windows", this->transaction.windows.size());
+
+	for (auto& pending: this->transaction.windows) {
+		this->setWindowGeometry(
+		    pending.window,
+		    pending.position,
+		    pending.size,
+		    pending.no_animation,
+		    pending.no_gaps
+		);
+	}
+
+	this->transaction.windows.clear();
+}
+
+void Hy3Layout::commitWindowGeometry(CWindow* window) {
+	auto pending = std::find_if(
+	    this->transaction.windows.begin(),
+	    this->transaction.windows.end(),
+	    [window](auto& pending) { return pending.window == window; }
+	);
+
+	if (pending == this->transaction.windows.end()) return;
+
+	this->setWindowGeometry(
+	    pending->window,
+	    pending->position,
+	    pending->size,
+	    pending->no_animation,
+	    pending->no_gaps
+	);
+
+	this->transaction.windows.erase(pending);
+}
+
+// The size a window is expected to commit after being configured to `size`, clamped to
+// its size hints as clients will not go past them.
+Vector2D getAckedSize(CWindow* window, Vector2D size) {
+	auto min = g_pXWaylandManager->getMinSizeForWindow(window);
+	auto max = g_pXWaylandManager->getMaxSizeForWindow(window);
+
+	// a max of 0 means unbounded
+	if (max.x > 0) size.x = std::min(size.x, max.x);
+	if (max.y > 0) size.y = std::min(size.y, max.y);
+
+	return Vector2D(std::max(size.x, min.x), std::max(size.y, min.y));
+}
+
+void Hy3Layout::updateTransaction() {
+	static const auto timeout = ConfigValue<Hyprlang::INT>("plugin:hy3:transactions:timeout");
+
+	if (this->transaction.windows.empty()) return;
+
+	auto elapsed = std::chrono::steady_clock::now() - this->transaction.started;
+
+	if (elapsed < std::chrono::milliseconds(*timeout)) {
+		for (auto& pending: this->transaction.windows) {
+			CBox geometry;
+			g_pXWaylandManager->getGeometryForWindow(pending.window, &geometry);
+
+			auto width = std::round(geometry.width);
+			auto height = std::round(geometry.height);
+			auto acked_size = getAckedSize(pending.window, pending.size);
+
+			// the client has not committed a buffer at the new size yet
+			if ((width != std::round(pending.size.x) || height != std::round(pending.size.y))
+			    && (width != std::round(acked_size.x) || height != std::round(acked_size.y)))
+				return;
+		}
+	} else {
+		hy3_log(
+		    LOG,
+		    "transaction of {} windows timed out, committing anyway",
+		    this->transaction.windows.size()
+		);
+	}
+
+	this->commitTransaction();
+}
+
 bool shiftIsForward(ShiftDirection direction) {
 	return direction == ShiftDirection::Right || direction == ShiftDirection::Down;
 }
@@ -1642,6 +2238,7 @@ Hy3Node* Hy3Layout::shiftOrGetFocus(
 				break_parent->data.as_group.children.push_back(newChild);
 				break_parent->data.as_group.group_focused = false;
 				break_parent->data.as_group.focused_child = newChild;
+				break_parent->data.as_group.user_created = true;
 				break_origin = newChild;
 			}
 
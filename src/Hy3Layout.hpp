@@ -8,8 +8,11 @@ enum class GroupEphemeralityOption {
 	ForceEphemeral,
 };
 
+#include <chrono>
 #include <list>
 #include <set>
+#include <unordered_map>
+#include <vector>
 
 #include <hyprland/src/layout/IHyprLayout.hpp>
 
@@ -117,10 +120,28 @@ public:
 	void setNodeSwallow(int workspace, SetSwallowOption);
 	void killFocusedNode(int workspace);
 	void expand(int workspace, ExpandOption, ExpandFullscreenOption);
+	// Flatten same-orientation nesting and collapse redundant single child groups.
+	void compactWorkspace(int workspace);
 
 	bool shouldRenderSelected(CWindow*);
 
 	Hy3Node* getWorkspaceRootGroup(const int& workspace);
+
+	struct WorkspaceContext {
+		CWorkspace* workspace = nullptr;
+		CMonitor* monitor = nullptr;
+		bool special = false;
+		SWorkspaceRule rule;
+	};
+
+	// Lookups shared by everything laid out or rendered on a workspace, resolved once and kept
+	// until the next frame or workspace, monitor or config change. nullptr if the workspace
+	// does not exist.
+	WorkspaceContext* getWorkspaceContext(int workspace);
+	void invalidateWorkspaceContexts();
+	// visit the tab group on the next tick. the tick hook is only registered while there
+	// are woken groups, a pending transaction or queued title updates.
+	void wakeTabGroup(Hy3TabGroup*);
 	Hy3Node* getWorkspaceFocusedNode(
 	    const int& workspace,
 	    bool ignore_group_focus = false,
@@ -130,14 +151,37 @@ public:
 	static void renderHook(void*, SCallbackInfo&, std::any);
 	static void windowGroupUrgentHook(void*, SCallbackInfo&, std::any);
 	static void windowGroupUpdateRecursiveHook(void*, SCallbackInfo&, std::any);
+	static void windowTitleHook(void*, SCallbackInfo&, std::any);
 	static void tickHook(void*, SCallbackInfo&, std::any);
+	static void windowCloseHook(void*, SCallbackInfo&, std::any);
+	static void workspaceContextHook(void*, SCallbackInfo&, std::any);
+	static void monitorRemovedHook(void*, SCallbackInfo&, std::any);
 
 	std::list<Hy3Node> nodes;
 	std::list<Hy3TabGroup> tab_groups;
+	// tab groups by the window they are drawn after, kept by Hy3TabGroup::setTargetWindow.
+	// nested tab groups can share a target window.
+	std::unordered_multimap<CWindow*, Hy3TabGroup*> tab_group_targets;
 
 private:
 	Hy3Node* getNodeFromWindow(CWindow*);
 	void applyNodeDataToWindow(Hy3Node*, bool no_animation = false);
+	// no_gaps windows are placed as-is, without warping or updating their decorations
+	void setWindowGeometry(
+	    CWindow*,
+	    Vector2D position,
+	    Vector2D size,
+	    bool no_animation,
+	    bool no_gaps = false
+	);
+
+	// present all pending layout changes at once, regardless of client acks
+	void commitTransaction();
+	// present the window's pending geometry now, if it has any. used before reading or
+	// replacing the window's geometry outside of the transaction.
+	void commitWindowGeometry(CWindow*);
+	// commit the pending transaction once all clients have caught up or it timed out
+	void updateTransaction();
 
 	// if shift is true, shift the window in the given direction, returning
 	// nullptr, if shift is false, return the window in the given direction or
@@ -147,6 +191,23 @@ private:
 	void updateAutotileWorkspaces();
 	bool shouldAutotileWorkspace(int);
 	void resizeNode(Hy3Node*, Vector2D, ShiftDirection resize_edge_x, ShiftDirection resize_edge_y);
+	void recalculateWorkspaceRoot(Hy3Node* root, CMonitor* monitor, bool reserved_only);
+
+	// compact the workspace once the event loop is idle, if auto_compact is enabled
+	void scheduleCompaction(int workspace);
+	static void compactionIdle(void*);
+
+	// apply queued title changes to the tab bars showing them, at most at tabs:title_rate
+	void flushTitleUpdates();
+
+	// resume suspended tab groups whose workspace became visible, and queue the others
+	// to be suspended by their next tick if their workspace is no longer shown.
+	void updateTabGroupVisibility();
+
+	// (un)register the tick hook once the event loop is idle if it is no longer or newly needed
+	void updateTickRegistration();
+	bool tickNeeded();
+	static void tickRegistrationIdle(void*);
 
 	struct {
 		std::string raw_workspaces;
@@ -154,5 +215,49 @@ private:
 		std::set<int> workspaces;
 	} autotile;
 
+	struct MonitorBox {
+		Vector2D position;
+		Vector2D size;
+	};
+
+	std::unordered_map<int, WorkspaceContext> workspace_contexts;
+
+	// outer monitor boxes as of the last recalculateMonitor call, keyed by monitor id
+	std::unordered_map<int, MonitorBox> monitor_boxes;
+
+	struct PendingWindowGeometry {
+		CWindow* window;
+		Vector2D position;
+		Vector2D size;
+		bool no_animation;
+		bool no_gaps;
+	};
+
+	// windows that have been sent a configure but are not yet presented at their new geometry
+	struct {
+		std::vector<PendingWindowGeometry> windows;
+		std::chrono::steady_clock::time_point started;
+	} transaction;
+
+	struct {
+		std::set<int> workspaces;
+		wl_event_source* idle_source = nullptr;
+	} compaction;
+
+	// windows whose title changed since the last flush, without duplicates
+	struct {
+		std::vector<CWindow*> windows;
+		std::chrono::steady_clock::time_point last_flush;
+	} title_updates;
+
+	struct {
+		// tab groups to visit on the next tick, see Hy3TabGroup::ticking
+		std::vector<Hy3TabGroup*> groups;
+		bool registered = false;
+		wl_event_source* idle_source = nullptr;
+		// false while the layout is disabled, groups are not woken and the hook stays unregistered
+		bool enabled = false;
+	} ticking;
+
 	friend struct Hy3Node;
 };
@@ -1,3 +1,4 @@
+#include <limits>
 #include <sstream>
 
 #include <hyprland/src/Compositor.hpp>
@@ -27,6 +28,7 @@ Hy3GroupData::Hy3GroupData(Hy3GroupData&& from) {
 	from.focused_child = nullptr;
 	this->tab_bar = from.tab_bar;
 	from.tab_bar = nullptr;
+	this->user_created = from.user_created;
 }
 
 Hy3GroupData::~Hy3GroupData() {
@@ -34,12 +36,11 @@ Hy3GroupData::~Hy3GroupData() {
 }
 
 bool Hy3GroupData::hasChild(Hy3Node* node) {
-	for (auto child: this->children) {
-		if (child == node) return true;
+	if (node == nullptr) return false;
 
-		if (child->data.type == Hy3NodeType::Group) {
-			if (child->data.as_group.hasChild(node)) return true;
-		}
+	// walk up from the node instead of searching the whole subtree
+	for (auto* parent = node->parent; parent != nullptr; parent = parent->parent) {
+		if (&parent->data.as_group == this) return true;
 	}
 
 	return false;
@@ -215,13 +216,20 @@ void Hy3Node::markFocused() {
 }
 
 void Hy3Node::raiseToTop() {
-	switch (this->data.type) {
-	case Hy3NodeType::Window: g_pCompositor->changeWindowZOrder(this->data.as_window, true); break;
-	case Hy3NodeType::Group:
-		for (auto* child: this->data.as_group.children) {
-			child->raiseToTop();
+	std::vector<Hy3Node*> stack = {this};
+
+	while (!stack.empty()) {
+		auto* node = stack.back();
+		stack.pop_back();
+
+		switch (node->data.type) {
+		case Hy3NodeType::Window: g_pCompositor->changeWindowZOrder(node->data.as_window, true); break;
+		case Hy3NodeType::Group:
+			// pushed in reverse so windows are raised in tree order
+			auto& children = node->data.as_group.children;
+			stack.insert(stack.end(), children.rbegin(), children.rend());
+			break;
 		}
-		break;
 	}
 }
 
@@ -268,7 +276,286 @@ Hy3Node& Hy3Node::getExpandActor() {
 	return *node;
 }
 
+// Hints are in the space a split divides between its children. The outer gap offsets at
+// the edges of a split (gaps_out at monitor edges) are taken out of that space before it is
+// divided, so within it every window is padded by exactly gaps_in and its reserved area.
+Hy3SizeHints getWindowSizeHints(Hy3Node& node) {
+	// clang-format off
+	static const auto gaps_in = ConfigValue<Hyprlang::CUSTOMTYPE, CCssGapData>("general:gaps_in");
+	// clang-format on
+
+	const auto unbounded = std::numeric_limits<double>::infinity();
+
+	auto* window = node.data.as_window;
+	if (window->m_bIsFullscreen) return {Vector2D(), Vector2D(unbounded, unbounded)};
+
+	auto reserved = window->getFullWindowReservedArea();
+	auto padding = Vector2D(gaps_in->left + gaps_in->right, gaps_in->top + gaps_in->bottom)
+	             + reserved.topLeft + reserved.bottomRight;
+
+	auto max = g_pXWaylandManager->getMaxSizeForWindow(window);
+
+	// a max of 0 means unbounded
+	return {
+	    g_pXWaylandManager->getMinSizeForWindow(window) + padding,
+	    Vector2D(
+	        max.x > 0 ? max.x + padding.x : unbounded,
+	        max.y > 0 ? max.y + padding.y : unbounded
+	    ),
+	};
+}
+
+// Combine the hints of a group's children, which must all be cached already.
+Hy3SizeHints
+getGroupSizeHints(Hy3Node& node, std::unordered_map<const Hy3Node*, Hy3SizeHints>& cache) {
+	// clang-format off
+	static const auto group_inset = ConfigValue<Hyprlang::INT>("plugin:hy3:group_inset");
+	static const auto tab_bar_height = ConfigValue<Hyprlang::INT>("plugin:hy3:tabs:height");
+	static const auto tab_bar_padding = ConfigValue<Hyprlang::INT>("plugin:hy3:tabs:padding");
+	// clang-format on
+
+	const auto unbounded = std::numeric_limits<double>::infinity();
+
+	auto& group = node.data.as_group;
+	Hy3SizeHints hints = {Vector2D(), Vector2D(unbounded, unbounded)};
+	if (group.children.empty()) return hints;
+
+	Vector2D max_sum;
+
+	for (auto* child: group.children) {
+		auto& child_hints = cache.at(child);
+
+		switch (group.layout) {
+		case Hy3GroupLayout::SplitH:
+			hints.min.x += child_hints.min.x;
+			hints.min.y = std::max(hints.min.y, child_hints.min.y);
+			max_sum.x += child_hints.max.x;
+			hints.max.y = std::min(hints.max.y, child_hints.max.y);
+			break;
+		case Hy3GroupLayout::SplitV:
+			hints.min.x = std::max(hints.min.x, child_hints.min.x);
+			hints.min.y += child_hints.min.y;
+			hints.max.x = std::min(hints.max.x, child_hints.max.x);
+			max_sum.y += child_hints.max.y;
+			break;
+		case Hy3GroupLayout::Tabbed:
+			hints.min.x = std::max(hints.min.x, child_hints.min.x);
+			hints.min.y = std::max(hints.min.y, child_hints.min.y);
+			hints.max.x = std::min(hints.max.x, child_hints.max.x);
+			hints.max.y = std::min(hints.max.y, child_hints.max.y);
+			break;
+		}
+	}
+
+	switch (group.layout) {
+	case Hy3GroupLayout::SplitH: hints.max.x = max_sum.x; break;
+	case Hy3GroupLayout::SplitV: hints.max.y = max_sum.y; break;
+	case Hy3GroupLayout::Tabbed:
+		hints.min.y += *tab_bar_height + *tab_bar_padding;
+		hints.max.y += *tab_bar_height + *tab_bar_padding;
+		break;
+	}
+
+	// the only child of a nested group is inset along the group's axis
+	if (group.children.size() == 1 && node.parent != nullptr) {
+		switch (group.layout) {
+		case Hy3GroupLayout::SplitH:
+			hints.min.x += *group_inset;
+			hints.max.x += *group_inset;
+			break;
+		case Hy3GroupLayout::SplitV:
+			hints.min.y += *group_inset;
+			hints.max.y += *group_inset;
+			break;
+		case Hy3GroupLayout::Tabbed: break;
+		}
+	}
+
+	// children whose limits conflict across the group cannot all be satisfied, prefer the mins
+	hints.max.x = std::max(hints.max.x, hints.min.x);
+	hints.max.y = std::max(hints.max.y, hints.min.y);
+
+	return hints;
+}
+
+const Hy3SizeHints& Hy3SizeHintCache::get(Hy3Node& node) {
+	auto cached = this->hints.find(&node);
+	if (cached != this->hints.end()) return cached->second;
+
+	// Walked with an explicit stack like recalcSizePosRecursive. A group is visited again
+	// once all of its children have been, so each node in the subtree is computed once.
+	std::vector<std::pair<Hy3Node*, bool>> stack = {{&node, false}};
+
+	while (!stack.empty()) {
+		auto [current, children_done] = stack.back();
+		stack.pop_back();
+
+		if (this->hints.contains(current)) continue;
+
+		if (current->data.type == Hy3NodeType::Window) {
+			this->hints.emplace(current, getWindowSizeHints(*current));
+		} else if (children_done) {
+			this->hints.emplace(current, getGroupSizeHints(*current, this->hints));
+		} else {
+			stack.emplace_back(current, true);
+
+			for (auto* child: current->data.as_group.children) {
+				if (!this->hints.contains(child)) stack.emplace_back(child, false);
+			}
+		}
+	}
+
+	return this->hints.at(&node);
+}
+
+// Divide `constraint` between the children of a split group by their size ratios.
+// If size hints are enabled, children whose share would fall outside their min/max
+// size are clamped and the leftover space is redistributed among the others.
+std::vector<double>
+solveSplit(Hy3GroupData& group, double constraint, Hy3SizeHintCache& hint_cache) {
+	static const auto size_hints = ConfigValue<Hyprlang::INT>("plugin:hy3:size_hints");
+
+	auto child_count = group.children.size();
+	std::vector<double> extents;
+	extents.reserve(child_count);
+
+	for (auto* child: group.children) {
+		extents.push_back(child->size_ratio * constraint / child_count);
+	}
+
+	if (!*size_hints || child_count < 2 || group.layout == Hy3GroupLayout::Tabbed) return extents;
+
+	auto horizontal = group.layout == Hy3GroupLayout::SplitH;
+	std::vector<double> mins;
+	std::vector<double> maxes;
+	double min_total = 0;
+	double max_total = 0;
+
+	for (auto* child: group.children) {
+		auto& hints = hint_cache.get(*child);
+		mins.push_back(horizontal ? hints.min.x : hints.min.y);
+		maxes.push_back(horizontal ? hints.max.x : hints.max.y);
+		min_total += mins.back();
+		max_total += maxes.back();
+	}
+
+	// hints that cannot all be satisfied are ignored rather than overlapping windows
+	if (min_total > constraint || max_total < constraint) return extents;
+
+	std::vector<bool> frozen(child_count, false);
+
+	while (true) {
+		double violation = 0;
+		bool violated = false;
+
+		for (size_t i = 0; i < child_count; i++) {
+			if (frozen[i]) continue;
+			auto clamped = std::clamp(extents[i], mins[i], maxes[i]);
+			violation += clamped - extents[i];
+			violated |= clamped != extents[i];
+		}
+
+		if (!violated) break;
+
+		// freeze the children violating in the dominant direction at their limits
+		for (size_t i = 0; i < child_count; i++) {
+			if (frozen[i]) continue;
+			auto clamped = std::clamp(extents[i], mins[i], maxes[i]);
+
+			if ((violation > 0 && clamped > extents[i]) || (violation < 0 && clamped < extents[i])
+			    || (violation == 0 && clamped != extents[i]))
+			{
+				extents[i] = clamped;
+				frozen[i] = true;
+			}
+		}
+
+		double remaining = constraint;
+		double flexible_ratio = 0;
+		size_t flexible_count = 0;
+
+		auto child = group.children.begin();
+		for (size_t i = 0; i < child_count; i++, child = std::next(child)) {
+			if (frozen[i]) {
+				remaining -= extents[i];
+			} else {
+				flexible_ratio += (*child)->size_ratio;
+				flexible_count++;
+			}
+		}
+
+		if (flexible_count == 0) break;
+
+		child = group.children.begin();
+		for (size_t i = 0; i < child_count; i++, child = std::next(child)) {
+			if (frozen[i]) continue;
+
+			extents[i] = flexible_ratio > 0 ? (*child)->size_ratio * remaining / flexible_ratio
+			                                : remaining / flexible_count;
+		}
+	}
+
+	return extents;
+}
+
+// Space along the split axis divided between the children of a split group.
+double getSplitConstraint(Hy3Node& node) {
+	// clang-format off
+	static const auto gaps_in = ConfigValue<Hyprlang::CUSTOMTYPE, CCssGapData>("general:gaps_in");
+	static const auto gaps_out = ConfigValue<Hyprlang::CUSTOMTYPE, CCssGapData>("general:gaps_out");
+	// clang-format on
+
+	auto gap_topleft_offset = node.gap_topleft_offset;
+	auto gap_bottomright_offset = node.gap_bottomright_offset;
+
+	if (node.parent == nullptr) {
+		// clang-format off
+		gap_topleft_offset = Vector2D(
+		    -(gaps_in->left - gaps_out->left),
+		    -(gaps_in->top - gaps_out->top)
+		);
+
+		gap_bottomright_offset = Vector2D(
+		    -(gaps_in->right - gaps_out->right),
+		    -(gaps_in->bottom - gaps_out->bottom)
+		);
+		// clang-format on
+	}
+
+	switch (node.data.as_group.layout) {
+	case Hy3GroupLayout::SplitH:
+		return node.size.x - gap_topleft_offset.x - gap_bottomright_offset.x;
+	case Hy3GroupLayout::SplitV:
+		return node.size.y - gap_topleft_offset.y - gap_bottomright_offset.y;
+	default: return 0;
+	}
+}
+
 void Hy3Node::recalcSizePosRecursive(bool no_animation) {
+	// Walked with an explicit stack as generated layouts can be hundreds of levels deep.
+	// Tab bars depend on their children's final geometry, so they are updated afterwards
+	// in reverse visiting order, which places every group after all of its descendants.
+	std::vector<Hy3Node*> stack = {this};
+	std::vector<Hy3Node*> groups;
+	Hy3SizeHintCache hint_cache;
+
+	while (!stack.empty()) {
+		auto* node = stack.back();
+		stack.pop_back();
+
+		if (node->recalcSizePos(no_animation, stack, hint_cache)) groups.push_back(node);
+	}
+
+	for (auto iter = groups.rbegin(); iter != groups.rend(); iter++) {
+		(*iter)->updateTabBar(no_animation);
+	}
+}
+
+bool Hy3Node::recalcSizePos(
+    bool no_animation,
+    std::vector<Hy3Node*>& pending,
+    Hy3SizeHintCache& hint_cache
+) {
 	// clang-format off
 	static const auto gaps_in = ConfigValue<Hyprlang::CUSTOMTYPE, CCssGapData>("general:gaps_in");
 	static const auto gaps_out = ConfigValue<Hyprlang::CUSTOMTYPE, CCssGapData>("general:gaps_out");
@@ -290,13 +577,18 @@ void Hy3Node::recalcSizePosRecursive(bool no_animation) {
 	// clang-format on
 
 	if (this->data.type == Hy3NodeType::Window && this->data.as_window->m_bIsFullscreen) {
-		auto* workspace = g_pCompositor->getWorkspaceByID(this->workspace_id);
-		auto* monitor = g_pCompositor->getMonitorFromID(workspace->m_iMonitorID);
+		auto* context = this->layout->getWorkspaceContext(this->workspace_id);
+		if (context == nullptr || context->monitor == nullptr) return false;
+
+		auto* workspace = context->workspace;
+		auto* monitor = context->monitor;
 
 		if (workspace->m_efFullscreenMode == FULLSCREEN_FULL) {
+			// a held geometry would replace the fullscreen one once presented
+			this->layout->commitWindowGeometry(this->data.as_window);
 			this->data.as_window->m_vRealPosition = monitor->vecPosition;
 			this->data.as_window->m_vRealSize = monitor->vecSize;
-			return;
+			return false;
 		}
 
 		Hy3Node fake_node = {
@@ -309,7 +601,7 @@ void Hy3Node::recalcSizePosRecursive(bool no_animation) {
 		};
 
 		this->layout->applyNodeDataToWindow(&fake_node);
-		return;
+		return false;
 	}
 
 	if (this->parent != nullptr) {
@@ -325,10 +617,11 @@ void Hy3Node::recalcSizePosRecursive(bool no_animation) {
 	if (this->data.type == Hy3NodeType::Window) {
 		this->data.as_window->setHidden(this->hidden);
 		this->layout->applyNodeDataToWindow(this, no_animation);
-		return;
+		return false;
 	}
 
 	auto* group = &this->data.as_group;
+	auto pending_start = pending.size();
 
 	double constraint;
 	switch (group->layout) {
@@ -347,11 +640,11 @@ void Hy3Node::recalcSizePosRecursive(bool no_animation) {
 	    && (group->focused_child->data.type == Hy3NodeType::Window
 	        || group->focused_child->data.as_group.expand_focused == ExpandFocusType::NotExpanded);
 
-	auto child_count = group->children.size();
-	double ratio_mul =
-	    group->layout != Hy3GroupLayout::Tabbed ? child_count <= 0 ? 0 : constraint / child_count : 0;
+	std::vector<double> extents;
+	if (group->layout != Hy3GroupLayout::Tabbed) extents = solveSplit(*group, constraint, hint_cache);
 
 	double offset = 0;
+	size_t child_index = 0;
 
 	if (group->layout == Hy3GroupLayout::Tabbed && group->focused_child != nullptr
 	    && !group->focused_child->hidden)
@@ -378,7 +671,7 @@ void Hy3Node::recalcSizePosRecursive(bool no_animation) {
 			    (uintptr_t) this
 			);
 			errorNotif();
-			return;
+			return false;
 		}
 
 		expanded_node->position = tpos;
@@ -388,24 +681,22 @@ void Hy3Node::recalcSizePosRecursive(bool no_animation) {
 		expanded_node->gap_topleft_offset = gap_topleft_offset;
 		expanded_node->gap_bottomright_offset = gap_bottomright_offset;
 
-		expanded_node->recalcSizePosRecursive(no_animation);
+		pending.push_back(expanded_node);
 	}
 
 	for (auto* child: group->children) {
-		if (directly_contains_expanded && child == group->focused_child) {
-			switch (group->layout) {
-			case Hy3GroupLayout::SplitH: offset += child->size_ratio * ratio_mul; break;
-			case Hy3GroupLayout::SplitV: offset += child->size_ratio * ratio_mul; break;
-			case Hy3GroupLayout::Tabbed: break;
-			}
+		auto child_extent = extents.empty() ? 0 : extents[child_index];
+		child_index++;
 
+		if (directly_contains_expanded && child == group->focused_child) {
+			offset += child_extent;
 			continue;
 		}
 
 		switch (group->layout) {
 		case Hy3GroupLayout::SplitH:
 			child->position.x = tpos.x + offset;
-			child->size.x = child->size_ratio * ratio_mul;
+			child->size.x = child_extent;
 			offset += child->size.x;
 			child->position.y = tpos.y;
 			child->size.y = tsize.y;
@@ -430,11 +721,11 @@ void Hy3Node::recalcSizePosRecursive(bool no_animation) {
 				child->gap_bottomright_offset = Vector2D(0, gap_bottomright_offset.y);
 			}
 
-			child->recalcSizePosRecursive(no_animation);
+			pending.push_back(child);
 			break;
 		case Hy3GroupLayout::SplitV:
 			child->position.y = tpos.y + offset;
-			child->size.y = child->size_ratio * ratio_mul;
+			child->size.y = child_extent;
 			offset += child->size.y;
 			child->position.x = tpos.x;
 			child->size.x = tsize.x;
@@ -459,7 +750,7 @@ void Hy3Node::recalcSizePosRecursive(bool no_animation) {
 				child->gap_bottomright_offset = Vector2D(gap_bottomright_offset.x, 0);
 			}
 
-			child->recalcSizePosRecursive(no_animation);
+			pending.push_back(child);
 			break;
 		case Hy3GroupLayout::Tabbed:
 			child->position = tpos;
@@ -470,12 +761,148 @@ void Hy3Node::recalcSizePosRecursive(bool no_animation) {
 			    Vector2D(gap_topleft_offset.x, gap_topleft_offset.y + tab_height_offset);
 			child->gap_bottomright_offset = gap_bottomright_offset;
 
-			child->recalcSizePosRecursive(no_animation);
+			pending.push_back(child);
+			break;
+		}
+	}
+
+	// keep the recursive visiting order
+	std::reverse(pending.begin() + pending_start, pending.end());
+	return true;
+}
+
+bool Hy3Node::moveEdgesRecursive(
+    Vector2D topleft_delta,
+    Vector2D bottomright_delta,
+    bool no_animation
+) {
+	struct EdgeMove {
+		Hy3Node* node;
+		Vector2D topleft_delta;
+		Vector2D bottomright_delta;
+	};
+
+	auto whole = [](Vector2D delta) {
+		return std::abs(delta.x - std::round(delta.x)) < 0.001
+		    && std::abs(delta.y - std::round(delta.y)) < 0.001;
+	};
+
+	// Every move is worked out before any is applied, walked with an explicit stack like
+	// recalcSizePosRecursive, so nothing is touched if the shift turns out to be inexact.
+	std::vector<EdgeMove> stack = {{this, topleft_delta, bottomright_delta}};
+	std::vector<EdgeMove> moves;
+	Hy3SizeHintCache hint_cache;
+
+	while (!stack.empty()) {
+		auto move = stack.back();
+		stack.pop_back();
+
+		// Fractional shifts would leave every later shift building on rounding error,
+		// only a full recalculation keeps the layout exact then.
+		if (!whole(move.topleft_delta) || !whole(move.bottomright_delta)) return false;
+
+		// nothing under an unmoved edge needs to be touched
+		if (move.topleft_delta == Vector2D() && move.bottomright_delta == Vector2D()) continue;
+
+		moves.push_back(move);
+
+		auto* node = move.node;
+		if (node->data.type == Hy3NodeType::Window) continue;
+
+		// expanded nodes do not follow the split flow and are recalculated when applied
+		auto& group = node->data.as_group;
+		if (group.expand_focused != ExpandFocusType::NotExpanded) continue;
+
+		// Mirrors the split math in recalcSizePos: gap offsets are constant, so each
+		// child moves by the change in its solved share of the split constraint.
+		auto child_count = group.children.size();
+		auto stack_start = stack.size();
+		auto constraint = getSplitConstraint(*node);
+		double size_delta;
+		double offset;
+		std::vector<double> extents_before;
+		std::vector<double> extents_after;
+		size_t child_index = 0;
+
+		switch (group.layout) {
+		case Hy3GroupLayout::SplitH:
+			size_delta = move.bottomright_delta.x - move.topleft_delta.x;
+			offset = move.topleft_delta.x;
+
+			extents_before = solveSplit(group, constraint, hint_cache);
+			extents_after = solveSplit(group, constraint + size_delta, hint_cache);
+
+			for (auto* child: group.children) {
+				auto child_delta = child_count == 1
+				                     ? size_delta
+				                     : extents_after[child_index] - extents_before[child_index];
+				child_index++;
+
+				stack.push_back({
+				    child,
+				    Vector2D(offset, move.topleft_delta.y),
+				    Vector2D(offset + child_delta, move.bottomright_delta.y),
+				});
+
+				offset += child_delta;
+			}
+			break;
+		case Hy3GroupLayout::SplitV:
+			size_delta = move.bottomright_delta.y - move.topleft_delta.y;
+			offset = move.topleft_delta.y;
+
+			extents_before = solveSplit(group, constraint, hint_cache);
+			extents_after = solveSplit(group, constraint + size_delta, hint_cache);
+
+			for (auto* child: group.children) {
+				auto child_delta = child_count == 1
+				                     ? size_delta
+				                     : extents_after[child_index] - extents_before[child_index];
+				child_index++;
+
+				stack.push_back({
+				    child,
+				    Vector2D(move.topleft_delta.x, offset),
+				    Vector2D(move.bottomright_delta.x, offset + child_delta),
+				});
+
+				offset += child_delta;
+			}
+			break;
+		case Hy3GroupLayout::Tabbed:
+			for (auto* child: group.children) {
+				stack.push_back({child, move.topleft_delta, move.bottomright_delta});
+			}
 			break;
 		}
+
+		// keep the recursive visiting order
+		std::reverse(stack.begin() + stack_start, stack.end());
 	}
 
-	this->updateTabBar(no_animation);
+	std::vector<Hy3Node*> groups;
+
+	for (auto& move: moves) {
+		auto* node = move.node;
+		node->position = node->position + move.topleft_delta;
+		node->size = node->size + move.bottomright_delta - move.topleft_delta;
+
+		if (node->data.type == Hy3NodeType::Window) {
+			if (node->data.as_window->m_bIsFullscreen) node->recalcSizePosRecursive(no_animation);
+			else node->layout->applyNodeDataToWindow(node, no_animation);
+		} else if (node->data.as_group.expand_focused != ExpandFocusType::NotExpanded) {
+			node->recalcSizePosRecursive(no_animation);
+		} else {
+			groups.push_back(node);
+		}
+	}
+
+	// tab bars are updated in reverse visiting order so every group follows its descendants
+	for (auto iter = groups.rbegin(); iter != groups.rend(); iter++) {
+		(*iter)->updateTabBar(no_animation);
+	}
+
+	return true;
 }
 
 struct FindTopWindowInNodeResult {
@@ -517,12 +944,14 @@ void Hy3Node::updateTabBar(bool no_animation) {
 
 		if (group.layout == Hy3GroupLayout::Tabbed) {
 			if (group.tab_bar == nullptr) group.tab_bar = &this->layout->tab_groups.emplace_back(*this);
-			group.tab_bar->updateWithGroup(*this, no_animation);
 
+			// the workspace is needed first to know if the group is suspended
 			FindTopWindowInNodeResult result;
 			findTopWindowInNode(*this, result);
-			group.tab_bar->target_window = result.window;
+			group.tab_bar->setTargetWindow(result.window);
 			if (result.window != nullptr) group.tab_bar->workspace_id = result.window->m_iWorkspaceID;
+
+			group.tab_bar->updateWithGroup(*this, no_animation);
 		} else if (group.tab_bar != nullptr) {
 			group.tab_bar->bar.beginDestroy();
 			group.tab_bar = nullptr;
@@ -540,17 +969,29 @@ void Hy3Node::updateTabBarRecursive() {
 }
 
 void Hy3Node::updateDecos() {
-	switch (this->data.type) {
-	case Hy3NodeType::Window:
-		if (this->data.as_window->m_bIsMapped)
-			g_pCompositor->updateWindowAnimatedDecorationValues(this->data.as_window);
-		break;
-	case Hy3NodeType::Group:
-		for (auto* child: this->data.as_group.children) {
-			child->updateDecos();
+	std::vector<Hy3Node*> stack = {this};
+	std::vector<Hy3Node*> groups;
+
+	while (!stack.empty()) {
+		auto* node = stack.back();
+		stack.pop_back();
+
+		switch (node->data.type) {
+		case Hy3NodeType::Window:
+			if (node->data.as_window->m_bIsMapped)
+				g_pCompositor->updateWindowAnimatedDecorationValues(node->data.as_window);
+			break;
+		case Hy3NodeType::Group:
+			auto& children = node->data.as_group.children;
+			stack.insert(stack.end(), children.rbegin(), children.rend());
+			groups.push_back(node);
+			break;
 		}
+	}
 
-		this->updateTabBar();
+	// tab bars are updated after everything beneath them
+	for (auto iter = groups.rbegin(); iter != groups.rend(); iter++) {
+		(*iter)->updateTabBar();
 	}
 }
 
@@ -579,24 +1020,38 @@ std::string Hy3Node::getTitle() {
 }
 
 bool Hy3Node::isUrgent() {
-	switch (this->data.type) {
-	case Hy3NodeType::Window: return this->data.as_window->m_bIsUrgent;
-	case Hy3NodeType::Group:
-		for (auto* child: this->data.as_group.children) {
-			if (child->isUrgent()) return true;
-		}
+	std::vector<Hy3Node*> stack = {this};
 
-		return false;
-	default: return false;
+	while (!stack.empty()) {
+		auto* node = stack.back();
+		stack.pop_back();
+
+		switch (node->data.type) {
+		case Hy3NodeType::Window:
+			if (node->data.as_window->m_bIsUrgent) return true;
+			break;
+		case Hy3NodeType::Group:
+			auto& children = node->data.as_group.children;
+			stack.insert(stack.end(), children.begin(), children.end());
+			break;
+		}
 	}
+
+	return false;
 }
 
 void Hy3Node::setHidden(bool hidden) {
-	this->hidden = hidden;
+	std::vector<Hy3Node*> stack = {this};
 
-	if (this->data.type == Hy3NodeType::Group) {
-		for (auto* child: this->data.as_group.children) {
-			child->setHidden(hidden);
+	while (!stack.empty()) {
+		auto* node = stack.back();
+		stack.pop_back();
+
+		node->hidden = hidden;
+
+		if (node->data.type == Hy3NodeType::Group) {
+			auto& children = node->data.as_group.children;
+			stack.insert(stack.end(), children.begin(), children.end());
 		}
 	}
 }
@@ -621,68 +1076,85 @@ Hy3Node* Hy3Node::findNodeForTabGroup(Hy3TabGroup& tab_group) {
 }
 
 void Hy3Node::appendAllWindows(std::vector<CWindow*>& list) {
-	switch (this->data.type) {
-	case Hy3NodeType::Window: list.push_back(this->data.as_window); break;
-	case Hy3NodeType::Group:
-		for (auto* child: this->data.as_group.children) {
-			child->appendAllWindows(list);
+	std::vector<Hy3Node*> stack = {this};
+
+	while (!stack.empty()) {
+		auto* node = stack.back();
+		stack.pop_back();
+
+		switch (node->data.type) {
+		case Hy3NodeType::Window: list.push_back(node->data.as_window); break;
+		case Hy3NodeType::Group:
+			// pushed in reverse so windows are appended in tree order
+			auto& children = node->data.as_group.children;
+			stack.insert(stack.end(), children.rbegin(), children.rend());
+			break;
 		}
-		break;
 	}
 }
 
 std::string Hy3Node::debugNode() {
 	std::stringstream buf;
-	std::string addr = "0x" + std::to_string((size_t) this);
-	switch (this->data.type) {
-	case Hy3NodeType::Window:
-		buf << "window(";
-		buf << std::hex << this;
-		buf << ") [hypr ";
-		buf << this->data.as_window;
-		buf << "] size ratio: ";
-		buf << this->size_ratio;
-		break;
-	case Hy3NodeType::Group:
-		buf << "group(";
-		buf << std::hex << this;
-		buf << ") [";
+	// node and its depth below this node, nullptr for missing children
+	std::vector<std::pair<Hy3Node*, size_t>> stack = {{this, 0}};
 
-		switch (this->data.as_group.layout) {
-		case Hy3GroupLayout::SplitH: buf << "splith"; break;
-		case Hy3GroupLayout::SplitV: buf << "splitv"; break;
-		case Hy3GroupLayout::Tabbed: buf << "tabs"; break;
-		}
-
-		buf << "] size ratio: ";
-		buf << this->size_ratio;
+	while (!stack.empty()) {
+		auto [node, depth] = stack.back();
+		stack.pop_back();
 
-		if (this->data.as_group.expand_focused != ExpandFocusType::NotExpanded) {
-			buf << ", has-expanded";
+		if (depth != 0) {
+			buf << "\n";
+			for (size_t i = 1; i < depth; i++) buf << "  ";
+			buf << "|-";
 		}
 
-		if (this->data.as_group.ephemeral) {
-			buf << ", ephemeral";
+		if (node == nullptr) {
+			buf << "nullptr";
+			continue;
 		}
 
-		if (this->data.as_group.containment) {
-			buf << ", containment";
-		}
+		switch (node->data.type) {
+		case Hy3NodeType::Window:
+			buf << "window(";
+			buf << std::hex << node;
+			buf << ") [hypr ";
+			buf << node->data.as_window;
+			buf << "] size ratio: ";
+			buf << node->size_ratio;
+			break;
+		case Hy3NodeType::Group:
+			buf << "group(";
+			buf << std::hex << node;
+			buf << ") [";
+
+			switch (node->data.as_group.layout) {
+			case Hy3GroupLayout::SplitH: buf << "splith"; break;
+			case Hy3GroupLayout::SplitV: buf << "splitv"; break;
+			case Hy3GroupLayout::Tabbed: buf << "tabs"; break;
+			}
 
-		for (auto* child: this->data.as_group.children) {
-			buf << "\n|-";
-			if (child == nullptr) {
-				buf << "nullptr";
-			} else {
-				// this is terrible
-				for (char c: child->debugNode()) {
-					buf << c;
-					if (c == '\n') buf << "  ";
-				}
+			buf << "] size ratio: ";
+			buf << node->size_ratio;
+
+			if (node->data.as_group.expand_focused != ExpandFocusType::NotExpanded) {
+				buf << ", has-expanded";
 			}
-		}
 
-		break;
+			if (node->data.as_group.ephemeral) {
+				buf << ", ephemeral";
+			}
+
+			if (node->data.as_group.containment) {
+				buf << ", containment";
+			}
+
+			auto& children = node->data.as_group.children;
+			for (auto iter = children.rbegin(); iter != children.rend(); iter++) {
+				stack.push_back({*iter, depth + 1});
+			}
+
+			break;
+		}
 	}
 
 	return buf.str();
@@ -767,7 +1239,8 @@ Hy3Node* Hy3Node::removeFromParentRecursive(Hy3Node** expand_actor) {
 	return parent;
 }
 
-Hy3Node* Hy3Node::intoGroup(Hy3GroupLayout layout, GroupEphemeralityOption ephemeral) {
+Hy3Node*
+Hy3Node::intoGroup(Hy3GroupLayout layout, GroupEphemeralityOption ephemeral, bool recalculate) {
 	this->layout->nodes.push_back({
 	    .parent = this,
 	    .data = layout,
@@ -784,8 +1257,11 @@ Hy3Node* Hy3Node::intoGroup(Hy3GroupLayout layout, GroupEphemeralityOption ephem
 	this->data.as_group.focused_child = node;
 	this->data.as_group.ephemeral = ephemeral == GroupEphemeralityOption::Ephemeral
 	                             || ephemeral == GroupEphemeralityOption::ForceEphemeral;
-	this->recalcSizePosRecursive();
-	this->updateTabBarRecursive();
+
+	if (recalculate) {
+		this->recalcSizePosRecursive();
+		this->updateTabBarRecursive();
+	}
 
 	return node;
 }
@@ -5,6 +5,7 @@ struct Hy3GroupData;
 enum class Hy3GroupLayout;
 
 #include <list>
+#include <unordered_map>
 
 #include <hyprland/src/desktop/Window.hpp>
 
@@ -37,6 +38,8 @@ struct Hy3GroupData {
 	ExpandFocusType expand_focused = ExpandFocusType::NotExpanded;
 	bool ephemeral = false;
 	bool containment = false;
+	// made by makegroup or by shifting a window rather than implicitly, never compacted away
+	bool user_created = false;
 	Hy3TabGroup* tab_bar = nullptr;
 
 	Hy3GroupData(Hy3GroupLayout layout);
@@ -78,6 +81,22 @@ public:
 	Hy3NodeData& operator=(Hy3NodeData&&);
 };
 
+// Size limits of a node's box, including the gaps and decorations around its windows.
+struct Hy3SizeHints {
+	Vector2D min;
+	Vector2D max;
+};
+
+// Size hints of the nodes of a tree, computed bottom-up for a whole subtree on first use and
+// kept for the rest of a single recalculation.
+class Hy3SizeHintCache {
+public:
+	const Hy3SizeHints& get(Hy3Node&);
+
+private:
+	std::unordered_map<const Hy3Node*, Hy3SizeHints> hints;
+};
+
 struct Hy3Node {
 	Hy3Node* parent = nullptr;
 	bool reparenting = false;
@@ -106,6 +125,15 @@ struct Hy3Node {
 	Hy3Node& getExpandActor();
 
 	void recalcSizePosRecursive(bool no_animation = false);
+	// Recalculate this node only, pushing the children that need recalculating onto
+	// `pending`. Returns true if the node is a group needing a tab bar update afterwards.
+	bool recalcSizePos(bool no_animation, std::vector<Hy3Node*>& pending, Hy3SizeHintCache&);
+	// Move the edges of this node by the given deltas, shifting the already solved
+	// geometry of its subtree instead of recalculating it. Returns false without moving
+	// anything if some node would be shifted by a fraction of a pixel, in which case the
+	// caller should recalculate instead.
+	bool
+	moveEdgesRecursive(Vector2D topleft_delta, Vector2D bottomright_delta, bool no_animation = false);
 	void updateTabBar(bool no_animation = false);
 	void updateTabBarRecursive();
 	void updateDecos();
@@ -125,7 +153,8 @@ struct Hy3Node {
 	Hy3Node* removeFromParentRecursive(Hy3Node** expand_actor);
 
 	// Replace this node with a group, returning this node's new address.
-	Hy3Node* intoGroup(Hy3GroupLayout, GroupEphemeralityOption);
+	// If recalculate is false the caller is responsible for recalculating the group.
+	Hy3Node* intoGroup(Hy3GroupLayout, GroupEphemeralityOption, bool recalculate = true);
 
 	// Attempt to swallow a group. returns true if swallowed
 	static bool swallowGroups(Hy3Node* into);
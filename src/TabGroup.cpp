@@ -7,68 +7,880 @@
 #include <hyprland/src/render/OpenGL.hpp>
 #include <pango/pangocairo.h>
 #include <pixman.h>
+#include <atomic>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
 
 #include "globals.hpp"
 
-Hy3TabBarEntry::Hy3TabBarEntry(Hy3TabBar& tab_bar, Hy3Node& node): tab_bar(tab_bar), node(node) {
-	this->focused.create(
-	    0.0f,
-	    g_pConfigManager->getAnimationPropertyConfig("fadeSwitch"),
-	    nullptr,
-	    AVARDAMAGE_NONE
-	);
+// Pango state shared by every tab title. The font description and context are kept for the
+// configured font and scale, and shaped layouts are kept for recently drawn titles so a tab
+// redrawn at a new size or state, or after its bar was re-enabled, is not shaped again.
+class Hy3TitleLayoutCache {
+public:
+	~Hy3TitleLayoutCache() { this->clear(); }
+
+	PangoLayout* get(
+	    const std::string& title,
+	    const char* font,
+	    int text_height,
+	    float scale,
+	    int width,
+	    bool center
+	) {
+		if (this->context == nullptr || this->font != font || this->text_height != text_height
+		    || this->scale != scale)
+		{
+			this->clear();
+			this->font = font;
+			this->text_height = text_height;
+			this->scale = scale;
+
+			this->context = pango_font_map_create_context(pango_cairo_font_map_get_default());
+			this->font_desc = pango_font_description_from_string(font);
+			pango_font_description_set_size(this->font_desc, text_height * scale * PANGO_SCALE);
+		}
 
-	this->urgent.create(
-	    0.0f,
-	    g_pConfigManager->getAnimationPropertyConfig("fadeSwitch"),
-	    nullptr,
-	    AVARDAMAGE_NONE
-	);
+		auto key = std::to_string(width) + (center ? "c" : "l") + title;
 
-	this->offset.create(
-	    -1.0f,
-	    g_pConfigManager->getAnimationPropertyConfig("windowsMove"),
-	    nullptr,
-	    AVARDAMAGE_NONE
-	);
+		auto cached = this->index.find(key);
+		if (cached != this->index.end()) {
+			this->layouts.splice(this->layouts.begin(), this->layouts, cached->second);
+			return cached->second->layout;
+		}
 
-	this->width.create(
-	    -1.0f,
-	    g_pConfigManager->getAnimationPropertyConfig("windowsMove"),
-	    nullptr,
-	    AVARDAMAGE_NONE
-	);
+		auto* layout = pango_layout_new(this->context);
+		pango_layout_set_text(layout, title.c_str(), -1);
+		if (center) pango_layout_set_alignment(layout, PANGO_ALIGN_CENTER);
+		pango_layout_set_font_description(layout, this->font_desc);
+		pango_layout_set_width(layout, width * PANGO_SCALE);
+		pango_layout_set_ellipsize(layout, PANGO_ELLIPSIZE_END);
+
+		this->layouts.push_front({key, layout});
+		this->index.emplace(key, this->layouts.begin());
+
+		if (this->layouts.size() > MAX_LAYOUTS) {
+			auto& oldest = this->layouts.back();
+			g_object_unref(oldest.layout);
+			this->index.erase(oldest.key);
+			this->layouts.pop_back();
+		}
 
-	this->vertical_pos.create(
-	    1.0f,
-	    g_pConfigManager->getAnimationPropertyConfig("windowsIn"),
-	    nullptr,
-	    AVARDAMAGE_NONE
-	);
+		return layout;
+	}
 
-	this->fade_opacity.create(
-	    0.0f,
-	    g_pConfigManager->getAnimationPropertyConfig("windowsIn"),
-	    nullptr,
-	    AVARDAMAGE_NONE
-	);
+private:
+	static constexpr size_t MAX_LAYOUTS = 256;
 
-	this->focused.registerVar();
-	this->urgent.registerVar();
-	this->offset.registerVar();
-	this->width.registerVar();
-	this->vertical_pos.registerVar();
-	this->fade_opacity.registerVar();
+	struct CachedLayout {
+		std::string key;
+		PangoLayout* layout;
+	};
 
-	auto update_callback = [this](void*) { this->tab_bar.dirty = true; };
+	std::string font;
+	int text_height = 0;
+	float scale = 0.0;
+	PangoContext* context = nullptr;
+	PangoFontDescription* font_desc = nullptr;
 
-	this->focused.setUpdateCallback(update_callback);
-	this->urgent.setUpdateCallback(update_callback);
-	this->offset.setUpdateCallback(update_callback);
-	this->width.setUpdateCallback(update_callback);
-	this->vertical_pos.setUpdateCallback(update_callback);
-	this->fade_opacity.setUpdateCallback(update_callback);
+	// most recently used first
+	std::list<CachedLayout> layouts;
+	std::unordered_map<std::string, std::list<CachedLayout>::iterator> index;
+
+	void clear() {
+		for (auto& cached: this->layouts) {
+			g_object_unref(cached.layout);
+		}
+
+		this->layouts.clear();
+		this->index.clear();
+
+		if (this->font_desc != nullptr) pango_font_description_free(this->font_desc);
+		if (this->context != nullptr) g_object_unref(this->context);
+		this->font_desc = nullptr;
+		this->context = nullptr;
+	}
+};
+
+// each worker shapes with its own pango state, pango objects are not thread safe
+thread_local Hy3TitleLayoutCache title_layouts;
+
+// Cairo surfaces each worker draws titles into, reused across jobs. Sizes are rounded up
+// to a size class so titles of tabs with slightly different widths share a surface.
+class Hy3TitleScratch {
+public:
+	struct Surface {
+		int width;
+		int height;
+		cairo_surface_t* surface;
+		cairo_t* cairo;
+	};
+
+	~Hy3TitleScratch() {
+		for (auto& surface: this->surfaces) {
+			cairo_destroy(surface.cairo);
+			cairo_surface_destroy(surface.surface);
+		}
+	}
+
+	Surface& get(int width, int height) {
+		width = (width + 63) / 64 * 64;
+		height = (height + 7) / 8 * 8;
+
+		for (auto iter = this->surfaces.begin(); iter != this->surfaces.end(); iter++) {
+			if (iter->width == width && iter->height == height) {
+				this->surfaces.splice(this->surfaces.begin(), this->surfaces, iter);
+				return this->surfaces.front();
+			}
+		}
+
+		auto* surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, width, height);
+		this->surfaces.push_front({width, height, surface, cairo_create(surface)});
+
+		if (this->surfaces.size() > MAX_SURFACES) {
+			auto& oldest = this->surfaces.back();
+			cairo_destroy(oldest.cairo);
+			cairo_surface_destroy(oldest.surface);
+			this->surfaces.pop_back();
+		}
+
+		return this->surfaces.front();
+	}
+
+private:
+	static constexpr size_t MAX_SURFACES = 4;
+
+	// most recently used first
+	std::list<Surface> surfaces;
+};
+
+thread_local Hy3TitleScratch title_scratch;
+
+// A title raster shared between a tab entry and the worker drawing it. Inputs are copied
+// so the worker never touches the entry; the entry only reads the pixels once done is set.
+struct Hy3TitleRasterJob {
+	std::string title;
+	std::string font;
+	int text_height = 0;
+	float scale = 0.0;
+	int width = 0;
+	int height = 0;
+	int padding = 0;
+	bool center = false;
+	CColor color;
+
+	std::vector<unsigned char> pixels;
+	std::atomic<bool> cancelled = false;
+	std::atomic<bool> done = false;
+
+	void run() {
+		auto& scratch = title_scratch.get(this->width, this->height);
+		auto* cairo = scratch.cairo;
+
+		cairo_save(cairo);
+		cairo_rectangle(cairo, 0, 0, this->width, this->height);
+		cairo_clip(cairo);
+
+		// clear pixmap
+		cairo_save(cairo);
+		cairo_set_operator(cairo, CAIRO_OPERATOR_CLEAR);
+		cairo_paint(cairo);
+		cairo_restore(cairo);
+
+		auto* layout = title_layouts.get(
+		    this->title,
+		    this->font.c_str(),
+		    this->text_height,
+		    this->scale,
+		    this->width - this->padding * 2,
+		    this->center
+		);
+
+		// only relayouts if the surface's font options differ from the last use
+		pango_cairo_update_layout(cairo, layout);
+
+		cairo_set_source_rgba(cairo, this->color.r, this->color.g, this->color.b, this->color.a);
+
+		int layout_width, layout_height;
+		pango_layout_get_size(layout, &layout_width, &layout_height);
+
+		auto y_offset = (this->height / 2.0) - (((double) layout_height / PANGO_SCALE) / 2.0);
+		cairo_move_to(cairo, this->padding, y_offset);
+		pango_cairo_show_layout(cairo, layout);
+
+		cairo_restore(cairo);
+
+		// flush cairo
+		cairo_surface_flush(scratch.surface);
+
+		// reuses the buffer's storage if this job was rasterized at this size before
+		auto row_size = this->width * 4;
+		this->pixels.resize(row_size * this->height);
+
+		auto* data = cairo_image_surface_get_data(scratch.surface);
+		auto stride = cairo_image_surface_get_stride(scratch.surface);
+
+		for (int row = 0; row < this->height; row++) {
+			std::memcpy(&this->pixels[row * row_size], data + row * stride, row_size);
+		}
+	}
+};
+
+class Hy3TitleRasterizer {
+public:
+	~Hy3TitleRasterizer() { this->stop(); }
+
+	void submit(std::shared_ptr<Hy3TitleRasterJob> job) {
+		std::unique_lock lock(this->mutex);
+
+		// no workers may be started once the plugin is being unloaded
+		if (this->stopped) {
+			job->cancelled = true;
+			return;
+		}
+
+		if (this->workers.empty()) {
+			auto count = std::clamp(std::thread::hardware_concurrency() / 4, 1u, 2u);
+
+			for (unsigned int i = 0; i < count; i++) {
+				this->workers.emplace_back([this] { this->work(); });
+			}
+		}
+
+		this->queue.push_back(std::move(job));
+		this->condition.notify_one();
+	}
+
+	// stop the workers for good, jobs submitted afterwards are dropped
+	void stop() {
+		{
+			std::unique_lock lock(this->mutex);
+			this->stopped = true;
+			this->condition.notify_all();
+		}
+
+		for (auto& worker: this->workers) {
+			worker.join();
+		}
+
+		this->workers.clear();
+		this->queue.clear();
+	}
+
+private:
+	std::mutex mutex;
+	std::condition_variable condition;
+	std::deque<std::shared_ptr<Hy3TitleRasterJob>> queue;
+	std::vector<std::thread> workers;
+	bool stopped = false;
+
+	void work() {
+		while (true) {
+			std::shared_ptr<Hy3TitleRasterJob> job;
+
+			{
+				std::unique_lock lock(this->mutex);
+				this->condition.wait(lock, [this] { return this->stopped || !this->queue.empty(); });
+				if (this->stopped) return;
+
+				job = std::move(this->queue.front());
+				this->queue.pop_front();
+			}
+
+			if (job->cancelled) continue;
+			job->run();
+			job->done = true;
+		}
+	}
+};
+
+Hy3TitleRasterizer title_rasterizer;
+
+void stopTitleRasterizer() { title_rasterizer.stop(); }
+
+// A rectangle of a Hy3TitleAtlas holding one title. Owned by the atlas; its position
+// changes when the atlas is repacked.
+struct Hy3TitleRegion {
+	Hy3TitleAtlas* atlas;
+	int x = 0;
+	int y = 0;
+	int width = 0;
+	int height = 0;
+};
+
+// One texture holding every tab title rasterized at a given scale, packed into shelves.
+// Titles are uploaded as sub-rectangles; space freed by destroyed entries is reclaimed by
+// repacking the live regions when an allocation no longer fits, growing the texture if
+// that is not enough.
+class Hy3TitleAtlas {
+public:
+	CTexture texture;
+
+	// Upload a finished raster, reusing `region` if it belongs to this atlas and has the
+	// same size. Returns the region now holding the title, or nullptr if it cannot fit.
+	Hy3TitleRegion* upload(Hy3TitleRegion* region, Hy3TitleRasterJob& job) {
+		if (region == nullptr || region->atlas != this || region->width != job.width
+		    || region->height != job.height)
+		{
+			if (region != nullptr) region->atlas->free(region);
+			region = this->allocate(job.width, job.height);
+			if (region == nullptr) return nullptr;
+		}
+
+		glBindTexture(GL_TEXTURE_2D, this->texture.m_iTexID);
+
+		glTexSubImage2D(
+		    GL_TEXTURE_2D,
+		    0,
+		    region->x,
+		    region->y,
+		    region->width,
+		    region->height,
+		    GL_RGBA,
+		    GL_UNSIGNED_BYTE,
+		    job.pixels.data()
+		);
+
+		return region;
+	}
+
+	void free(Hy3TitleRegion* region) {
+		auto iter = std::find_if(this->regions.begin(), this->regions.end(), [&](auto& r) {
+			return r.get() == region;
+		});
+
+		if (iter == this->regions.end()) return;
+
+		// give the space back if this was the last region placed on its shelf
+		for (auto& shelf: this->shelves) {
+			if (shelf.y == region->y && shelf.x == region->x + region->width) {
+				shelf.x = region->x;
+				break;
+			}
+		}
+
+		std::swap(*iter, this->regions.back());
+		this->regions.pop_back();
+
+		// drop the texture entirely once no titles are left at this scale
+		if (this->regions.empty()) {
+			this->shelves.clear();
+			this->texture.destroyTexture();
+		}
+	}
+
+	// draw a region of the atlas into the given box
+	void render(Hy3TitleRegion& region, CBox* box, float alpha) {
+		auto& render_data = g_pHyprOpenGL->m_RenderData;
+		auto size = this->texture.m_vSize;
+
+		render_data.primarySurfaceUVTopLeft = Vector2D(region.x / size.x, region.y / size.y);
+		render_data.primarySurfaceUVBottomRight = Vector2D(
+		    (region.x + region.width) / size.x,
+		    (region.y + region.height) / size.y
+		);
+
+		g_pHyprOpenGL->renderTexture(this->texture, box, alpha, 0, false, true);
+
+		render_data.primarySurfaceUVTopLeft = Vector2D(-1, -1);
+		render_data.primarySurfaceUVBottomRight = Vector2D(-1, -1);
+	}
+
+private:
+	static constexpr int INITIAL_SIZE = 512;
+
+	struct Shelf {
+		int y;
+		int height;
+		int x; // end of the last region placed on the shelf
+	};
+
+	std::vector<std::unique_ptr<Hy3TitleRegion>> regions;
+	std::vector<Shelf> shelves;
+
+	Hy3TitleRegion* allocate(int width, int height) {
+		auto region = std::make_unique<Hy3TitleRegion>(this, 0, 0, width, height);
+
+		auto placed = this->texture.m_iTexID != 0
+		           && place(*region, this->shelves, this->texture.m_vSize);
+
+		if (!placed && !this->repack(*region)) return nullptr;
+
+		return this->regions.emplace_back(std::move(region)).get();
+	}
+
+	// place a region on the first shelf of a similar height with room left, or a new shelf
+	static bool place(Hy3TitleRegion& region, std::vector<Shelf>& shelves, Vector2D size) {
+		if (region.width > size.x) return false;
+
+		for (auto& shelf: shelves) {
+			if (shelf.height < region.height || shelf.height > region.height * 5 / 4
+			    || shelf.x + region.width > size.x)
+				continue;
+
+			region.x = shelf.x;
+			region.y = shelf.y;
+			shelf.x += region.width;
+			return true;
+		}
+
+		auto y = shelves.empty() ? 0 : shelves.back().y + shelves.back().height;
+		if (y + region.height > size.y) return false;
+
+		shelves.push_back({.y = y, .height = region.height, .x = region.width});
+		region.x = 0;
+		region.y = y;
+		return true;
+	}
+
+	// Pack the live regions and `added` into a fresh texture, tallest first, doubling its
+	// size from the initial size until they fit. Live regions are copied over on the GPU.
+	bool repack(Hy3TitleRegion& added) {
+		GLint max_size;
+		glGetIntegerv(GL_MAX_TEXTURE_SIZE, &max_size);
+		max_size = std::min(max_size, 8192);
+
+		std::vector<Hy3TitleRegion*> order;
+		order.reserve(this->regions.size() + 1);
+		for (auto& region: this->regions) order.push_back(region.get());
+		order.push_back(&added);
+
+		std::stable_sort(order.begin(), order.end(), [](auto* a, auto* b) {
+			return a->height > b->height;
+		});
+
+		auto size = Vector2D(INITIAL_SIZE, INITIAL_SIZE);
+
+		std::vector<Shelf> shelves;
+		std::vector<Hy3TitleRegion> placed(order.size(), Hy3TitleRegion {this});
+
+		while (true) {
+			shelves.clear();
+
+			bool fits = true;
+			for (size_t i = 0; fits && i < order.size(); i++) {
+				placed[i].width = order[i]->width;
+				placed[i].height = order[i]->height;
+				fits = place(placed[i], shelves, size);
+			}
+
+			if (fits) break;
+			if (size.x >= max_size && size.y >= max_size) {
+				hy3_log(ERR, "tab title atlas cannot grow past {}x{}", max_size, max_size);
+				return false;
+			}
+
+			if (size.y < size.x) size.y = std::min(size.y * 2, (double) max_size);
+			else size.x = std::min(size.x * 2, (double) max_size);
+		}
+
+		GLuint texture;
+		glGenTextures(1, &texture);
+		glBindTexture(GL_TEXTURE_2D, texture);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+
+#ifdef GLES32
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_R, GL_BLUE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_B, GL_RED);
+#endif
+
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, size.x, size.y, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+
+		if (this->texture.m_iTexID != 0) {
+			GLint read_framebuffer;
+			glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &read_framebuffer);
+
+			GLuint framebuffer;
+			glGenFramebuffers(1, &framebuffer);
+			glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer);
+			glFramebufferTexture2D(
+			    GL_READ_FRAMEBUFFER,
+			    GL_COLOR_ATTACHMENT0,
+			    GL_TEXTURE_2D,
+			    this->texture.m_iTexID,
+			    0
+			);
+
+			for (size_t i = 0; i < order.size(); i++) {
+				if (order[i] == &added) continue;
+
+				glCopyTexSubImage2D(
+				    GL_TEXTURE_2D,
+				    0,
+				    placed[i].x,
+				    placed[i].y,
+				    order[i]->x,
+				    order[i]->y,
+				    order[i]->width,
+				    order[i]->height
+				);
+			}
+
+			glBindFramebuffer(GL_READ_FRAMEBUFFER, read_framebuffer);
+			glDeleteFramebuffers(1, &framebuffer);
+		}
+
+		for (size_t i = 0; i < order.size(); i++) {
+			order[i]->x = placed[i].x;
+			order[i]->y = placed[i].y;
+		}
+
+		this->texture.destroyTexture();
+		this->texture.m_iTexID = texture;
+		this->texture.m_vSize = size;
+		this->shelves = std::move(shelves);
+
+		return true;
+	}
+};
+
+// Title atlases by scale. Intentionally leaked so their textures are not deleted after the
+// GL context is gone on exit.
+Hy3TitleAtlas& getTitleAtlas(float scale) {
+	static auto* atlases = new std::unordered_map<float, Hy3TitleAtlas>();
+	return (*atlases)[scale];
+}
+
+// Draws a tab bar's backgrounds and titles, in order, with one draw call per damaged
+// rectangle. Backgrounds are rounded in the fragment shader so they can share the batch
+// with the titles, which all come from the same atlas. The shaders only use GLSL ES 1.00 so
+// the batch also runs on GLES2 and software renderers. If they fail to build, quads are
+// drawn one by one instead.
+class Hy3TabBatch {
+public:
+	struct Quad {
+		CBox box;
+		CColor color;       // the background color, or white with the title's opacity
+		double rounding = 0.0;
+		Hy3TitleRegion* region = nullptr;
+		// Titles fading between text colors are drawn as layers with weights summing to 1.
+		// Every layer after the first is added to it without covering what is below again,
+		// so the result is a linear blend of the layers. Titles only.
+		double weight = 1.0;
+		bool additive = false;
+	};
+
+	void begin() { this->quads.clear(); }
+	void add(Quad quad) { this->quads.push_back(quad); }
+
+	// draw the quads added since begin(), clipped to the damage inside `bounds`.
+	void flush(const CBox& bounds) {
+		if (this->quads.empty()) return;
+		if (this->drawBatched(bounds)) return;
+
+		for (auto& quad: this->quads) {
+			if (quad.region == nullptr) {
+				g_pHyprOpenGL->renderRect(&quad.box, quad.color, quad.rounding);
+			} else if (!quad.additive) {
+				// layers cannot be added without the shader, only the first and heaviest is drawn
+				quad.region->atlas->render(*quad.region, &quad.box, quad.color.a);
+			}
+		}
+	}
+
+	void destroy() {
+		if (this->program != 0) glDeleteProgram(this->program);
+		if (this->buffer != 0) glDeleteBuffers(1, &this->buffer);
+		this->program = 0;
+		this->buffer = 0;
+		this->failed = false;
+	}
+
+private:
+	struct Vertex {
+		float x, y;
+		float u, v;
+		// position relative to the quad's center, used for rounding
+		float local_x, local_y;
+		float half_width, half_height, rounding, textured;
+		// premultiplied
+		float r, g, b, a;
+	};
+
+	std::vector<Quad> quads;
+	std::vector<Vertex> vertices;
+	GLuint program = 0;
+	GLuint buffer = 0;
+	bool failed = false;
+
+	struct {
+		GLint proj;
+		GLint tex;
+		GLint pos;
+		GLint texcoord;
+		GLint local;
+		GLint shape;
+		GLint color;
+	} locations;
+
+	static constexpr const char* VERTEX_SHADER = R"(
+uniform mat3 proj;
+attribute vec2 pos;
+attribute vec2 texcoord;
+attribute vec2 local;
+attribute vec4 shape;
+attribute vec4 color;
+varying vec2 v_texcoord;
+varying vec2 v_local;
+varying vec4 v_shape;
+varying vec4 v_color;
+
+void main() {
+	gl_Position = vec4(proj * vec3(pos, 1.0), 1.0);
+	v_texcoord = texcoord;
+	v_local = local;
+	v_shape = shape;
+	v_color = color;
+})";
+
+	static constexpr const char* FRAGMENT_SHADER = R"(
+#ifdef GL_FRAGMENT_PRECISION_HIGH
+precision highp float;
+#else
+precision mediump float;
+#endif
+uniform sampler2D tex;
+varying vec2 v_texcoord;
+varying vec2 v_local;
+varying vec4 v_shape;
+varying vec4 v_color;
+
+void main() {
+	vec4 pixel = v_shape.w > 0.5 ? texture2D(tex, v_texcoord) : vec4(1.0);
+	vec2 q = abs(v_local) - v_shape.xy + v_shape.z;
+	float distance = length(max(q, 0.0)) + min(max(q.x, q.y), 0.0) - v_shape.z;
+	float coverage = clamp(0.5 - distance, 0.0, 1.0);
+
+	// keeps the stencil pass from writing outside rounded corners
+	if (coverage <= 0.0) discard;
+	gl_FragColor = pixel * v_color * coverage;
+})";
+
+	static GLuint compileShader(GLenum type, const char* source) {
+		auto shader = glCreateShader(type);
+		glShaderSource(shader, 1, &source, nullptr);
+		glCompileShader(shader);
+
+		GLint ok;
+		glGetShaderiv(shader, GL_COMPILE_STATUS, &ok);
+		if (ok == GL_FALSE) {
+			char log[512];
+			glGetShaderInfoLog(shader, sizeof(log), nullptr, log);
+			hy3_log(ERR, "failed to compile tab bar shader: {}", log);
+			glDeleteShader(shader);
+			return 0;
+		}
+
+		return shader;
+	}
+
+	bool init() {
+		if (this->program != 0) return true;
+		if (this->failed) return false;
+		this->failed = true;
+
+		auto vertex = compileShader(GL_VERTEX_SHADER, VERTEX_SHADER);
+		auto fragment = compileShader(GL_FRAGMENT_SHADER, FRAGMENT_SHADER);
+
+		if (vertex == 0 || fragment == 0) {
+			if (vertex != 0) glDeleteShader(vertex);
+			if (fragment != 0) glDeleteShader(fragment);
+			return false;
+		}
+
+		auto program = glCreateProgram();
+		glAttachShader(program, vertex);
+		glAttachShader(program, fragment);
+		glLinkProgram(program);
+		glDetachShader(program, vertex);
+		glDetachShader(program, fragment);
+		glDeleteShader(vertex);
+		glDeleteShader(fragment);
+
+		GLint ok;
+		glGetProgramiv(program, GL_LINK_STATUS, &ok);
+		if (ok == GL_FALSE) {
+			hy3_log(ERR, "failed to link tab bar shader, drawing tabs unbatched");
+			glDeleteProgram(program);
+			return false;
+		}
+
+		this->program = program;
+		this->locations.proj = glGetUniformLocation(program, "proj");
+		this->locations.tex = glGetUniformLocation(program, "tex");
+		this->locations.pos = glGetAttribLocation(program, "pos");
+		this->locations.texcoord = glGetAttribLocation(program, "texcoord");
+		this->locations.local = glGetAttribLocation(program, "local");
+		this->locations.shape = glGetAttribLocation(program, "shape");
+		this->locations.color = glGetAttribLocation(program, "color");
+
+		glGenBuffers(1, &this->buffer);
+		this->failed = false;
+		return true;
+	}
+
+	void pushQuad(const Quad& quad) {
+		auto& box = quad.box;
+		auto half_width = box.width * 0.5;
+		auto half_height = box.height * 0.5;
+
+		Vertex corner = {
+		    .half_width = (float) half_width,
+		    .half_height = (float) half_height,
+		    .rounding = (float) quad.rounding,
+		    .textured = quad.region == nullptr ? 0.0f : 1.0f,
+		    .r = quad.color.r * quad.color.a,
+		    .g = quad.color.g * quad.color.a,
+		    .b = quad.color.b * quad.color.a,
+		    .a = quad.color.a,
+		};
+
+		if (quad.region != nullptr) {
+			// Titles modulate the atlas with their opacity and layer weight only. Added layers
+			// keep a source alpha of 0, which turns the premultiplied over blend into a sum.
+			corner.r = corner.g = corner.b = quad.color.a * quad.weight;
+			corner.a = quad.additive ? 0.0f : quad.color.a;
+		}
+
+		Vertex corners[4];
+		for (int i = 0; i < 4; i++) {
+			auto right = i % 2 == 1;
+			auto bottom = i >= 2;
+			auto& vertex = corners[i] = corner;
+
+			vertex.x = box.x + (right ? box.width : 0.0);
+			vertex.y = box.y + (bottom ? box.height : 0.0);
+			vertex.local_x = right ? half_width : -half_width;
+			vertex.local_y = bottom ? half_height : -half_height;
+
+			if (quad.region != nullptr) {
+				auto& region = *quad.region;
+				auto size = region.atlas->texture.m_vSize;
+				vertex.u = (region.x + (right ? region.width : 0)) / size.x;
+				vertex.v = (region.y + (bottom ? region.height : 0)) / size.y;
+			}
+		}
+
+		for (auto i: {0, 1, 2, 2, 1, 3}) {
+			this->vertices.push_back(corners[i]);
+		}
+	}
+
+	bool drawBatched(const CBox& bounds) {
+		Hy3TitleAtlas* atlas = nullptr;
+
+		for (auto& quad: this->quads) {
+			if (quad.region == nullptr) continue;
+			// titles from several atlases cannot share a draw call
+			if (atlas != nullptr && quad.region->atlas != atlas) return false;
+			atlas = quad.region->atlas;
+		}
+
+		if (!this->init()) return false;
+
+		this->vertices.clear();
+		for (auto& quad: this->quads) {
+			this->pushQuad(quad);
+		}
+
+		auto& render_data = g_pHyprOpenGL->m_RenderData;
+
+		float matrix[9];
+		matrixMultiply(matrix, render_data.projection, render_data.pMonitor->projMatrix.data());
+
+		glUseProgram(this->program);
+
+#ifndef GLES2
+		glUniformMatrix3fv(this->locations.proj, 1, GL_TRUE, matrix);
+#else
+		wlr_matrix_transpose(matrix, matrix);
+		glUniformMatrix3fv(this->locations.proj, 1, GL_FALSE, matrix);
+#endif
+
+		glActiveTexture(GL_TEXTURE0);
+		glBindTexture(GL_TEXTURE_2D, atlas == nullptr ? 0 : atlas->texture.m_iTexID);
+		glUniform1i(this->locations.tex, 0);
+
+		glEnable(GL_BLEND);
+		glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+
+		glBindBuffer(GL_ARRAY_BUFFER, this->buffer);
+		glBufferData(
+		    GL_ARRAY_BUFFER,
+		    this->vertices.size() * sizeof(Vertex),
+		    this->vertices.data(),
+		    GL_STREAM_DRAW
+		);
+
+		auto attribute = [](GLint location, GLint size, size_t offset) {
+			glEnableVertexAttribArray(location);
+			glVertexAttribPointer(location, size, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*) offset);
+		};
+
+		attribute(this->locations.pos, 2, offsetof(Vertex, x));
+		attribute(this->locations.texcoord, 2, offsetof(Vertex, u));
+		attribute(this->locations.local, 2, offsetof(Vertex, local_x));
+		attribute(this->locations.shape, 4, offsetof(Vertex, half_width));
+		attribute(this->locations.color, 4, offsetof(Vertex, r));
+
+		pixman_region32 damage;
+		pixman_region32_init(&damage);
+
+		pixman_region32_intersect_rect(
+		    &damage,
+		    render_data.damage.pixman(),
+		    bounds.x,
+		    bounds.y,
+		    bounds.width,
+		    bounds.height
+		);
+
+		int rect_count;
+		auto* rects = pixman_region32_rectangles(&damage, &rect_count);
+
+		for (int i = 0; i < rect_count; i++) {
+			auto& rect = rects[i];
+			CBox scissor_box = {
+			    (double) rect.x1,
+			    (double) rect.y1,
+			    (double) rect.x2 - rect.x1,
+			    (double) rect.y2 - rect.y1,
+			};
+
+			g_pHyprOpenGL->scissor(&scissor_box);
+			glDrawArrays(GL_TRIANGLES, 0, this->vertices.size());
+		}
+
+		g_pHyprOpenGL->scissor((CBox*) nullptr);
+		pixman_region32_fini(&damage);
+
+		glDisableVertexAttribArray(this->locations.pos);
+		glDisableVertexAttribArray(this->locations.texcoord);
+		glDisableVertexAttribArray(this->locations.local);
+		glDisableVertexAttribArray(this->locations.shape);
+		glDisableVertexAttribArray(this->locations.color);
 
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		glBindTexture(GL_TEXTURE_2D, 0);
+
+		return true;
+	}
+};
+
+Hy3TabBatch tab_batch;
+
+void destroyTabBatch() { tab_batch.destroy(); }
+
+Hy3TabBarEntry::Hy3TabBarEntry(Hy3TabBar& tab_bar, Hy3Node& node)
+    : tab_bar(&tab_bar)
+    , node(&node) {
 	this->window_title = node.getTitle();
 	this->urgent = node.isUrgent();
 
@@ -76,7 +888,15 @@ Hy3TabBarEntry::Hy3TabBarEntry(Hy3TabBar& tab_bar, Hy3Node& node): tab_bar(tab_b
 	this->fade_opacity = 1.0;
 }
 
-bool Hy3TabBarEntry::operator==(const Hy3Node& node) const { return this->node == node; }
+Hy3TabBarEntry::ScaledTitles::~ScaledTitles() {
+	// the worker keeps its own reference to the job, it only needs to know to skip it
+	for (auto& title: this->titles) {
+		if (title.job != nullptr) title.job->cancelled = true;
+		if (title.region != nullptr) title.region->atlas->free(title.region);
+	}
+}
+
+bool Hy3TabBarEntry::operator==(const Hy3Node& node) const { return this->node == &node; }
 
 bool Hy3TabBarEntry::operator==(const Hy3TabBarEntry& entry) const {
 	return this->node == entry.node;
@@ -98,7 +918,8 @@ void Hy3TabBarEntry::setUrgent(bool urgent) {
 void Hy3TabBarEntry::setWindowTitle(std::string title) {
 	if (this->window_title != title) {
 		this->window_title = title;
-		this->tab_bar.dirty = true;
+		this->dirty = true;
+		this->tab_bar->wake();
 	}
 }
 
@@ -118,159 +939,159 @@ bool Hy3TabBarEntry::shouldRemove() {
 	return this->destroying && (this->vertical_pos.value() == 1.0 || this->width.value() == 0.0);
 }
 
-void Hy3TabBarEntry::prepareTexture(float scale, CBox& box) {
+void Hy3TabBarEntry::damageLastBox() {
+	if (this->damage_box.width > 0 && this->damage_box.height > 0)
+		g_pHyprRenderer->damageBox(&this->damage_box);
+}
+
+Hy3TitleRegion*
+Hy3TabBarEntry::prepareTitle(float scale, CBox& box, Hy3TabTextColor text_color) {
 	// clang-format off
-	static const auto s_rounding = ConfigValue<Hyprlang::INT>("plugin:hy3:tabs:rounding");
-	static const auto render_text = ConfigValue<Hyprlang::INT>("plugin:hy3:tabs:render_text");
 	static const auto text_center = ConfigValue<Hyprlang::INT>("plugin:hy3:tabs:text_center");
 	static const auto text_font = ConfigValue<Hyprlang::STRING>("plugin:hy3:tabs:text_font");
 	static const auto text_height = ConfigValue<Hyprlang::INT>("plugin:hy3:tabs:text_height");
 	static const auto text_padding = ConfigValue<Hyprlang::INT>("plugin:hy3:tabs:text_padding");
-	static const auto col_active = ConfigValue<Hyprlang::INT>("plugin:hy3:tabs:col.active");
-	static const auto col_urgent = ConfigValue<Hyprlang::INT>("plugin:hy3:tabs:col.urgent");
-	static const auto col_inactive = ConfigValue<Hyprlang::INT>("plugin:hy3:tabs:col.inactive");
 	static const auto col_text_active = ConfigValue<Hyprlang::INT>("plugin:hy3:tabs:col.text.active");
 	static const auto col_text_urgent = ConfigValue<Hyprlang::INT>("plugin:hy3:tabs:col.text.urgent");
 	static const auto col_text_inactive = ConfigValue<Hyprlang::INT>("plugin:hy3:tabs:col.text.inactive");
 	// clang-format on
 
+	// titles not drawn at a scale for this long are dropped
+	static constexpr auto SCALE_TIMEOUT = std::chrono::seconds(10);
+
 	auto width = box.width;
 	auto height = box.height;
 
-	auto rounding = std::min((double) *s_rounding * scale, std::min(width * 0.5, height * 0.5));
+	auto now = std::chrono::steady_clock::now();
+	ScaledTitles* scaled = nullptr;
 
-	if (this->texture.m_iTexID == 0
+	auto iter = this->scaled_titles.begin();
+	while (iter != this->scaled_titles.end()) {
+		if (iter->scale == scale) {
+			scaled = &*iter;
+			iter = std::next(iter);
+		} else if (now - iter->last_used > SCALE_TIMEOUT) {
+			iter = this->scaled_titles.erase(iter);
+		} else {
+			iter = std::next(iter);
+		}
+	}
+
+	if (scaled == nullptr) {
+		scaled = &this->scaled_titles.emplace_back();
+		scaled->scale = scale;
+	}
+
+	scaled->last_used = now;
+	auto& last_render = scaled->last_render;
+
+	if (last_render.width != width
 	    // clang-format off
-			|| this->last_render.x != box.x
-			|| this->last_render.y != box.y
-	    || this->last_render.focused != this->focused.value()
-			|| this->last_render.urgent != this->urgent.value()
-	    || this->last_render.window_title != this->window_title
-	    || this->last_render.rounding != rounding
-			|| this->last_render.text_font != *text_font
-	    || this->last_render.text_height != *text_height
-	    || this->last_render.text_padding != *text_padding
-	    || this->last_render.col_active != *col_active
-			|| this->last_render.col_urgent != *col_urgent
-	    || this->last_render.col_inactive != *col_inactive
-	    || this->last_render.col_text_active != *col_text_active
-	    || this->last_render.col_text_urgent != *col_text_urgent
-	    || this->last_render.col_text_inactive != *col_text_inactive
+	    || last_render.height != height
+	    || last_render.window_title != this->window_title
+	    || last_render.text_font != *text_font
+	    || last_render.text_height != *text_height
+	    || last_render.text_padding != *text_padding
+	    || last_render.text_center != *text_center
+	    || last_render.col_text_active != *col_text_active
+	    || last_render.col_text_urgent != *col_text_urgent
+	    || last_render.col_text_inactive != *col_text_inactive
 	    // clang-format on
 	)
 	{
-		this->last_render.x = box.x;
-		this->last_render.y = box.y;
-		this->last_render.focused = this->focused.value();
-		this->last_render.urgent = this->urgent.value();
-		this->last_render.window_title = this->window_title;
-		this->last_render.rounding = rounding;
-		this->last_render.text_font = *text_font;
-		this->last_render.text_height = *text_height;
-		this->last_render.text_padding = *text_padding;
-		this->last_render.col_active = *col_active;
-		this->last_render.col_urgent = *col_urgent;
-		this->last_render.col_inactive = *col_inactive;
-		this->last_render.col_text_active = *col_text_active;
-		this->last_render.col_text_urgent = *col_text_urgent;
-		this->last_render.col_text_inactive = *col_text_inactive;
-
-		auto cairo_surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, width, height);
-		auto cairo = cairo_create(cairo_surface);
-
-		// clear pixmap
-		cairo_save(cairo);
-		cairo_set_operator(cairo, CAIRO_OPERATOR_CLEAR);
-		cairo_paint(cairo);
-		cairo_restore(cairo);
-
-		// set brush
-		auto focused = this->focused.value();
-		auto urgent = this->urgent.value();
-		auto inactive = 1.0 - (focused + urgent);
-		auto c = (CColor(*col_active) * focused) + (CColor(*col_urgent) * urgent)
-		       + (CColor(*col_inactive) * inactive);
-
-		cairo_set_source_rgba(cairo, c.r, c.g, c.b, c.a);
-
-		// outline bar shape
-		cairo_move_to(cairo, 0, rounding);
-		cairo_arc(cairo, rounding, rounding, rounding, -180.0 * (M_PI / 180.0), -90.0 * (M_PI / 180.0));
-		cairo_line_to(cairo, width - rounding, 0);
-		cairo_arc(cairo, width - rounding, rounding, rounding, -90.0 * (M_PI / 180.0), 0.0);
-		cairo_line_to(cairo, width, height - rounding);
-		cairo_arc(cairo, width - rounding, height - rounding, rounding, 0.0, 90.0 * (M_PI / 180.0));
-		cairo_line_to(cairo, rounding, height);
-		cairo_arc(
-		    cairo,
-		    rounding,
-		    height - rounding,
-		    rounding,
-		    -270.0 * (M_PI / 180.0),
-		    -180.0 * (M_PI / 180.0)
-		);
-		cairo_close_path(cairo);
+		last_render.width = width;
+		last_render.height = height;
+		last_render.window_title = this->window_title;
+		last_render.text_font = *text_font;
+		last_render.text_height = *text_height;
+		last_render.text_padding = *text_padding;
+		last_render.text_center = *text_center;
+		last_render.col_text_active = *col_text_active;
+		last_render.col_text_urgent = *col_text_urgent;
+		last_render.col_text_inactive = *col_text_inactive;
+
+		// old textures are kept and drawn until their replacement is ready
+		for (auto& title: scaled->titles) {
+			if (title.job != nullptr) title.job->cancelled = true;
+			title.job = nullptr;
+			title.current = false;
+		}
+	}
 
-		// draw
-		cairo_fill(cairo);
+	auto& title = scaled->titles[(size_t) text_color];
 
-		// render window title
-		if (*render_text) {
-			PangoLayout* layout = pango_cairo_create_layout(cairo);
-			pango_layout_set_text(layout, this->window_title.c_str(), -1);
+	if (title.job != nullptr && title.job->done) {
+		auto job = std::move(title.job);
+		title.current = true;
+		title.region = getTitleAtlas(job->scale).upload(title.region, *job);
+		title.spare_job = std::move(job);
+	}
 
-			if (*text_center) pango_layout_set_alignment(layout, PANGO_ALIGN_CENTER);
+	if (!title.current && title.job == nullptr && width >= 1 && height >= 1) {
+		std::shared_ptr<Hy3TitleRasterJob> job;
 
-			PangoFontDescription* font_desc = pango_font_description_from_string(*text_font);
-			pango_font_description_set_size(font_desc, *text_height * scale * PANGO_SCALE);
-			pango_layout_set_font_description(layout, font_desc);
-			pango_font_description_free(font_desc);
+		// reuse the last finished job and its pixel buffer if no worker still holds it
+		if (title.spare_job != nullptr && title.spare_job.use_count() == 1) {
+			job = std::move(title.spare_job);
+			std::atomic_thread_fence(std::memory_order_acquire);
+			job->done = false;
+		} else {
+			job = std::make_shared<Hy3TitleRasterJob>();
+		}
 
-			int padding = *text_padding * scale;
-			int width = box.width - padding * 2;
+		job->title = this->window_title;
+		job->font = *text_font;
+		job->text_height = *text_height;
+		job->scale = scale;
+		job->width = width;
+		job->height = height;
+		job->padding = *text_padding * scale;
+		job->center = *text_center;
+
+		switch (text_color) {
+		case Hy3TabTextColor::Inactive: job->color = CColor(*col_text_inactive); break;
+		case Hy3TabTextColor::Active: job->color = CColor(*col_text_active); break;
+		case Hy3TabTextColor::Urgent: job->color = CColor(*col_text_urgent); break;
+		}
 
-			pango_layout_set_width(layout, width * PANGO_SCALE);
-			pango_layout_set_ellipsize(layout, PANGO_ELLIPSIZE_END);
+		title.job = job;
+		title.redraw_requested = false;
+		title_rasterizer.submit(std::move(job));
 
-			auto c = (CColor(*col_text_active) * focused) + (CColor(*col_text_urgent) * urgent)
-			       + (CColor(*col_text_inactive) * inactive);
+		// polled by the group's tick until done
+		this->tab_bar->wake();
+	}
 
-			cairo_set_source_rgba(cairo, c.r, c.g, c.b, c.a);
+	return title.region;
+}
 
-			int layout_width, layout_height;
-			pango_layout_get_size(layout, &layout_width, &layout_height);
+bool Hy3TabBarEntry::takeFinishedTitles() {
+	bool finished = false;
 
-			auto y_offset = (height / 2.0) - (((double) layout_height / PANGO_SCALE) / 2.0);
-			cairo_move_to(cairo, padding, y_offset);
-			pango_cairo_show_layout(cairo, layout);
-			g_object_unref(layout);
+	for (auto& scaled: this->scaled_titles) {
+		for (auto& title: scaled.titles) {
+			if (title.job == nullptr || title.redraw_requested || !title.job->done) continue;
+			title.redraw_requested = true;
+			finished = true;
 		}
+	}
 
-		// flush cairo
-		cairo_surface_flush(cairo_surface);
-
-		auto data = cairo_image_surface_get_data(cairo_surface);
-		this->texture.allocate();
-
-		glBindTexture(GL_TEXTURE_2D, this->texture.m_iTexID);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-
-#ifdef GLES32
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_R, GL_BLUE);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_B, GL_RED);
-#endif
+	return finished;
+}
 
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
+void Hy3TabBarEntry::releaseTitles() { this->scaled_titles.clear(); }
 
-		cairo_destroy(cairo);
-		cairo_surface_destroy(cairo_surface);
-	} else {
-		glBindTexture(GL_TEXTURE_2D, this->texture.m_iTexID);
+bool Hy3TabBarEntry::hasPendingTitles() {
+	for (auto& scaled: this->scaled_titles) {
+		for (auto& title: scaled.titles) {
+			if (title.job != nullptr && !title.redraw_requested) return true;
+		}
 	}
+
+	return false;
 }
 
-Hy3TabBar::Hy3TabBar() {
+Hy3TabBar::Hy3TabBar(Hy3TabGroup& group): group(group) {
 	this->fade_opacity.create(
 	    1.0f,
 	    g_pConfigManager->getAnimationPropertyConfig("windowsMove"),
@@ -278,106 +1099,214 @@ Hy3TabBar::Hy3TabBar() {
 	    AVARDAMAGE_NONE
 	);
 
+	this->scroll.create(
+	    0.0f,
+	    g_pConfigManager->getAnimationPropertyConfig("windowsMove"),
+	    nullptr,
+	    AVARDAMAGE_NONE
+	);
+
+	auto update_callback = [this](void*) {
+		this->dirty = true;
+		this->wake();
+	};
+
 	this->fade_opacity.registerVar();
-	this->fade_opacity.setUpdateCallback([this](void*) { this->dirty = true; });
+	this->fade_opacity.setUpdateCallback(update_callback);
+	this->scroll.registerVar();
+	this->scroll.setUpdateCallback(update_callback);
 }
 
 void Hy3TabBar::beginDestroy() {
+	// a suspended group is only ticked, and so destroyed, once woken
+	this->group.suspended = false;
+
 	for (auto& entry: this->entries) {
 		entry.beginDestroy();
 	}
+
+	this->wake();
+}
+
+void Hy3TabBar::wake() {
+	if (!this->group.suspended) g_Hy3Layout->wakeTabGroup(&this->group);
 }
 
 void Hy3TabBar::tick() {
-	auto iter = this->entries.begin();
+	this->animating = this->stepAnimations();
+	this->titles_pending = false;
 
+	auto iter = this->entries.begin();
 	while (iter != this->entries.end()) {
-		if (iter->shouldRemove()) iter = this->entries.erase(iter);
-		else iter = std::next(iter);
+		if (iter->shouldRemove()) {
+			iter->damageLastBox();
+			iter = this->entries.erase(iter);
+		} else {
+			// finished titles are uploaded when the bar is next drawn
+			if (iter->takeFinishedTitles()) iter->dirty = true;
+			if (iter->hasPendingTitles()) this->titles_pending = true;
+
+			iter = std::next(iter);
+		}
 	}
 
 	if (this->entries.empty()) this->destroy = true;
 }
 
-void Hy3TabBar::updateNodeList(std::list<Hy3Node*>& nodes) {
-	std::list<std::list<Hy3TabBarEntry>::iterator> removed_entries;
+namespace {
+// An animation config resolved for one step of every entry in a bar.
+struct Hy3TabAnimationStep {
+	bool enabled;
+	std::chrono::duration<float, std::milli> duration;
+	CBezierCurve* bezier;
 
-	auto entry = this->entries.begin();
-	auto node = nodes.begin();
+	Hy3TabAnimationStep(SAnimationPropertyConfig* config, bool animations_enabled) {
+		auto* values = config->pValues != nullptr ? config->pValues : config;
 
-	// move any out of order entries to removed_entries
-	while (node != nodes.end()) {
-		while (true) {
-			if (entry == this->entries.end()) goto exitloop;
-			if (*entry == **node) break;
-			removed_entries.push_back(entry);
-			entry = std::next(entry);
+		this->enabled = animations_enabled && values->internalEnabled != 0;
+		this->duration = std::chrono::duration<float, std::milli>(values->internalSpeed * 100.0);
+		this->bezier = g_pAnimationManager->getBezier(values->internalBezier);
+	}
+};
+} // namespace
+
+bool Hy3TabBar::stepAnimations() {
+	static const auto animations_enabled = ConfigValue<Hyprlang::INT>("animations:enabled");
+	static auto* const fade_switch = g_pConfigManager->getAnimationPropertyConfig("fadeSwitch");
+	static auto* const windows_move = g_pConfigManager->getAnimationPropertyConfig("windowsMove");
+	static auto* const windows_in = g_pConfigManager->getAnimationPropertyConfig("windowsIn");
+
+	auto fade_switch_step = Hy3TabAnimationStep(fade_switch, *animations_enabled);
+	auto windows_move_step = Hy3TabAnimationStep(windows_move, *animations_enabled);
+	auto windows_in_step = Hy3TabAnimationStep(windows_in, *animations_enabled);
+
+	auto now = std::chrono::steady_clock::now();
+	bool animating = false;
+
+	// returns true if the value changed
+	auto step = [&](Hy3TabAnimatedValue& value, const Hy3TabAnimationStep& config) {
+		if (!value.animating) return false;
+
+		auto progress = (now - value.started) / config.duration;
+
+		if (!config.enabled || config.bezier == nullptr || config.duration.count() <= 0
+		    || progress >= 1.0)
+		{
+			value.warp();
+		} else {
+			auto y = config.bezier->getYForPoint(progress);
+			value.current = value.begin + (value.target - value.begin) * y;
+			animating = true;
 		}
 
-		node = std::next(node);
-		entry = std::next(entry);
+		return true;
+	};
+
+	for (auto& entry: this->entries) {
+		bool changed = false;
+
+		changed |= step(entry.focused, fade_switch_step);
+		changed |= step(entry.urgent, fade_switch_step);
+		changed |= step(entry.offset, windows_move_step);
+		changed |= step(entry.width, windows_move_step);
+		changed |= step(entry.vertical_pos, windows_in_step);
+		changed |= step(entry.fade_opacity, windows_in_step);
+
+		if (changed) entry.dirty = true;
 	}
 
-exitloop:
+	return animating;
+}
+
+void Hy3TabBar::updateNodeList(std::list<Hy3Node*>& nodes) {
+	// nodes compare by identity, so their addresses key the diff
+	std::unordered_map<const Hy3Node*, size_t> entries_by_node;
+	std::unordered_set<const Hy3Node*> node_set;
 
-	// move any extra entries to removed_entries
-	while (entry != this->entries.end()) {
-		removed_entries.push_back(entry);
-		entry = std::next(entry);
+	entries_by_node.reserve(this->entries.size());
+	node_set.reserve(nodes.size());
+
+	for (size_t i = 0; i < this->entries.size(); i++) {
+		entries_by_node.emplace(this->entries[i].node, i);
 	}
 
-	entry = this->entries.begin();
-	node = nodes.begin();
+	for (auto* node: nodes) {
+		node_set.insert(node);
+	}
 
-	// add missing entries, taking first from removed_entries
-	while (node != nodes.end()) {
-		if (entry == this->entries.end() || *entry != **node) {
-			if (std::find(removed_entries.begin(), removed_entries.end(), entry) != removed_entries.end())
-			{
-				entry = std::next(entry);
-				continue;
-			}
+	// every node shares the same parent, the group this bar belongs to
+	bool group_focused = false;
+	Hy3GroupData* group = nullptr;
 
-			auto moved =
-			    std::find_if(removed_entries.begin(), removed_entries.end(), [&node](auto entry) {
-				    return **node == *entry;
-			    });
-
-			if (moved != removed_entries.end()) {
-				this->entries.splice(entry, this->entries, *moved);
-				entry = *moved;
-				removed_entries.erase(moved);
-			} else {
-				entry = this->entries.emplace(entry, *this, **node);
-			}
+	if (!nodes.empty()) {
+		auto* parent = nodes.front()->parent;
+		group = &parent->data.as_group;
+		group_focused = group->group_focused && parent->isIndirectlyFocused();
+	}
+
+	// Rebuild the entries in node order, moving each node's entry, or a new one, into place.
+	// Entries of removed nodes keep their position relative to the entry before them so they
+	// animate out where they were.
+	auto old_entries = std::move(this->entries);
+	std::vector<bool> moved(old_entries.size(), false);
+	size_t cursor = 0;
+
+	this->entries.clear();
+	this->entries.reserve(old_entries.size() + nodes.size());
+
+	for (auto* node: nodes) {
+		for (; cursor < old_entries.size(); cursor++) {
+			if (moved[cursor]) continue;
+			if (node_set.contains(old_entries[cursor].node)) break;
+
+			this->entries.push_back(std::move(old_entries[cursor]));
+			moved[cursor] = true;
 		}
 
-		entry->unDestroy();
+		Hy3TabBarEntry* entry;
+		auto existing = entries_by_node.find(node);
 
-		// set stats from node data
-		auto* parent = (*node)->parent;
-		auto& parent_group = parent->data.as_group;
+		if (existing == entries_by_node.end()) {
+			entry = &this->entries.emplace_back(*this, *node);
+		} else {
+			entry = &this->entries.emplace_back(std::move(old_entries[existing->second]));
+			moved[existing->second] = true;
 
-		entry->setFocused(
-		    parent_group.focused_child == *node
-		    || (parent_group.group_focused && parent->isIndirectlyFocused())
-		);
+			if (entry->destroying) entry->unDestroy();
+		}
 
-		entry->setUrgent((*node)->isUrgent());
-		entry->setWindowTitle((*node)->getTitle());
+		// the setters only touch the entry if its state changed
+		entry->setFocused(group->focused_child == node || group_focused);
+		entry->setUrgent(node->isUrgent());
+		entry->setWindowTitle(node->getTitle());
+	}
 
-		node = std::next(node);
-		if (entry != this->entries.end()) entry = std::next(entry);
+	for (; cursor < old_entries.size(); cursor++) {
+		if (!moved[cursor]) this->entries.push_back(std::move(old_entries[cursor]));
 	}
 
 	// initiate remove animations for any removed entries
-	for (auto& entry: removed_entries) {
+	auto entry = this->entries.begin();
+	while (entry != this->entries.end()) {
+		if (node_set.contains(entry->node)) {
+			entry = std::next(entry);
+			continue;
+		}
+
 		if (!entry->destroying) entry->beginDestroy();
-		if (entry->shouldRemove()) this->entries.erase(entry);
+
+		if (entry->shouldRemove()) {
+			entry->damageLastBox();
+			entry = this->entries.erase(entry);
+		} else {
+			entry = std::next(entry);
+		}
 	}
 }
 
 void Hy3TabBar::updateAnimations(bool warp) {
+	static const auto min_width = ConfigValue<Hyprlang::INT>("plugin:hy3:tabs:min_width");
+
 	int active_entries = 0;
 	for (auto& entry: this->entries) {
 		if (!entry.destroying) active_entries++;
@@ -386,6 +1315,14 @@ void Hy3TabBar::updateAnimations(bool warp) {
 	float entry_width = active_entries == 0 ? 0.0 : 1.0 / active_entries;
 	float offset = 0.0;
 
+	// entries narrower than the minimum turn the bar into a scrolling strip
+	auto bar_width = this->group.size.goal().x;
+	if (*min_width > 0 && bar_width > 0 && active_entries != 0) {
+		entry_width = std::max(entry_width, (float) (*min_width / bar_width));
+	}
+
+	float focused_offset = -1.0;
+
 	auto entry = this->entries.begin();
 	while (entry != this->entries.end()) {
 		if (warp) {
@@ -412,9 +1349,26 @@ void Hy3TabBar::updateAnimations(bool warp) {
 			}
 		}
 
-		if (!entry->destroying) offset += entry->width.goal();
+		if (!entry->destroying) {
+			if (entry->focused.goal() == 1.0) focused_offset = offset;
+			offset += entry->width.goal();
+		}
+
 		entry = std::next(entry);
 	}
+
+	// keep the focused entry in view, scrolling as little as possible
+	auto max_scroll = std::max(offset - 1.0f, 0.0f);
+	auto scroll = std::clamp(this->scroll.goal(), 0.0f, max_scroll);
+
+	if (focused_offset != -1.0) {
+		if (focused_offset < scroll) scroll = focused_offset;
+		else if (focused_offset + entry_width > scroll + 1.0)
+			scroll = focused_offset + entry_width - 1.0;
+	}
+
+	if (warp) this->scroll.setValueAndWarp(scroll);
+	else if (this->scroll.goal() != scroll) this->scroll = scroll;
 }
 
 void Hy3TabBar::setSize(Vector2D size) {
@@ -422,7 +1376,7 @@ void Hy3TabBar::setSize(Vector2D size) {
 	this->size = size;
 }
 
-Hy3TabGroup::Hy3TabGroup(Hy3Node& node) {
+Hy3TabGroup::Hy3TabGroup(Hy3Node& node): bar(*this) {
 	this->pos.create(
 	    g_pConfigManager->getAnimationPropertyConfig("windowsMove"),
 	    nullptr,
@@ -438,6 +1392,9 @@ Hy3TabGroup::Hy3TabGroup(Hy3Node& node) {
 	this->pos.registerVar();
 	this->size.registerVar();
 
+	this->pos.setUpdateCallback([this](void*) { this->bar.wake(); });
+	this->size.setUpdateCallback([this](void*) { this->bar.wake(); });
+
 	this->updateWithGroup(node, true);
 	this->pos.warp();
 	this->size.warp();
@@ -448,6 +1405,15 @@ void Hy3TabGroup::updateWithGroup(Hy3Node& node, bool warp) {
 	static const auto gaps_out = ConfigValue<Hyprlang::CUSTOMTYPE, CCssGapData>("general:gaps_out");
 	static const auto bar_height = ConfigValue<Hyprlang::INT>("plugin:hy3:tabs:height");
 
+	if (this->suspended) {
+		if (!this->isVisible()) return;
+
+		// state changed while suspended is applied without animating
+		this->suspended = false;
+		warp = true;
+		this->bar.dirty = true;
+	}
+
 	auto& gaps = node.parent == nullptr ? gaps_out : gaps_in;
 	auto tpos = node.position + Vector2D(gaps->left, gaps->top) + node.gap_topleft_offset;
 
@@ -475,15 +1441,27 @@ void Hy3TabGroup::updateWithGroup(Hy3Node& node, bool warp) {
 	if (node.data.as_group.focused_child != nullptr) {
 		this->updateStencilWindows(*node.data.as_group.focused_child);
 	}
+
+	this->bar.wake();
 }
 
-void Hy3TabGroup::tick() {
+bool Hy3TabGroup::tick() {
 	static const auto enter_from_top = ConfigValue<Hyprlang::INT>("plugin:hy3:tabs:from_top");
 	static const auto padding = ConfigValue<Hyprlang::INT>("plugin:hy3:tabs:padding");
-	auto* workspace = g_pCompositor->getWorkspaceByID(this->workspace_id);
+	auto* context = g_Hy3Layout->getWorkspaceContext(this->workspace_id);
+	auto* workspace = context == nullptr ? nullptr : context->workspace;
 
 	this->bar.tick();
 
+	if (!this->bar.destroy && !this->isVisible()) {
+		this->suspend();
+		return false;
+	}
+
+	// The workspace switch hooks fire once its slide or fade out has started. Nothing else
+	// wakes the group when it ends, so keep ticking until it can be suspended.
+	auto leaving = !this->bar.destroy && !this->isWorkspaceShown();
+
 	if (workspace != nullptr) {
 		if (workspace->m_bHasFullscreenWindow) {
 			if (this->bar.fade_opacity.goal() != 0.0) this->bar.fade_opacity = 0.0;
@@ -495,37 +1473,78 @@ void Hy3TabGroup::tick() {
 	auto pos = this->pos.value();
 	auto size = this->size.value();
 
-	if (this->last_pos != pos || this->last_size != size) {
-		CBox damage_box = {this->last_pos.x, this->last_pos.y, this->last_size.x, this->last_size.y};
+	// every entry moves with the bar
+	auto moved = this->last_pos != pos || this->last_size != size;
+	this->last_pos = pos;
+	this->last_size = size;
+
+	auto whole_bar = this->bar.destroy || this->bar.dirty;
+
+	if (whole_bar) {
+		// damage any area that could be covered by bar in/out animations
+		auto damage_size = Vector2D(size.x, size.y * 2 + *padding);
+		auto damage_pos = Vector2D(pos.x, *enter_from_top ? pos.y - *padding : pos.y);
+
+		CBox damage_box = {damage_pos, damage_size};
 		g_pHyprRenderer->damageBox(&damage_box);
 
 		this->bar.damaged = true;
-		this->last_pos = pos;
-		this->last_size = size;
 	}
 
-	if (this->bar.destroy || this->bar.dirty) {
-		// damage any area that could be covered by bar in/out animations
-		size.y = size.y * 2 + *padding;
-		if (*enter_from_top) {
-			pos.y -= *padding;
-		}
+	auto scroll = this->bar.scroll.value();
 
-		CBox damage_box = {pos.x, pos.y, size.x, size.y};
-		g_pHyprRenderer->damageBox(&damage_box);
+	// Damage the previous and current rects of changed entries only, so a single tab's
+	// fade does not recomposite the whole bar and the windows below it.
+	for (auto& entry: this->bar.entries) {
+		if (!entry.dirty && !moved && !whole_bar) continue;
+
+		CBox entry_box = {
+		    pos.x + (entry.offset.value() - scroll) * size.x + *padding * 0.5,
+		    pos.y
+		        + entry.vertical_pos.value() * (size.y + *padding) * (*enter_from_top ? -1 : 1),
+		    entry.width.value() * size.x - *padding,
+		    size.y,
+		};
+
+		// entries scrolled partly out of the strip are clipped to the bar
+		auto x2 = std::min(entry_box.x + entry_box.width, pos.x + size.x);
+		entry_box.x = std::max(entry_box.x, pos.x);
+		entry_box.width = x2 - entry_box.x;
 
+		// the whole bar was damaged above already
+		if (!whole_bar) {
+			entry.damageLastBox();
+
+			if (entry_box.width > 0 && entry_box.height > 0) g_pHyprRenderer->damageBox(&entry_box);
+		}
+
+		entry.damage_box = entry_box;
+		entry.dirty = false;
 		this->bar.damaged = true;
-		this->bar.dirty = false;
 	}
+
+	this->bar.dirty = false;
+	return this->bar.titles_pending || this->bar.animating || leaving;
 }
 
 void Hy3TabGroup::renderTabBar() {
+	// clang-format off
 	static const auto window_rounding = ConfigValue<Hyprlang::INT>("decoration:rounding");
 	static const auto enter_from_top = ConfigValue<Hyprlang::INT>("plugin:hy3:tabs:from_top");
 	static const auto padding = ConfigValue<Hyprlang::INT>("plugin:hy3:tabs:padding");
+	static const auto s_rounding = ConfigValue<Hyprlang::INT>("plugin:hy3:tabs:rounding");
+	static const auto render_text = ConfigValue<Hyprlang::INT>("plugin:hy3:tabs:render_text");
+	static const auto col_active = ConfigValue<Hyprlang::INT>("plugin:hy3:tabs:col.active");
+	static const auto col_urgent = ConfigValue<Hyprlang::INT>("plugin:hy3:tabs:col.urgent");
+	static const auto col_inactive = ConfigValue<Hyprlang::INT>("plugin:hy3:tabs:col.inactive");
+	static const auto col_text_active = ConfigValue<Hyprlang::INT>("plugin:hy3:tabs:col.text.active");
+	static const auto col_text_urgent = ConfigValue<Hyprlang::INT>("plugin:hy3:tabs:col.text.urgent");
+	static const auto col_text_inactive = ConfigValue<Hyprlang::INT>("plugin:hy3:tabs:col.text.inactive");
+	// clang-format on
 
 	auto* monitor = g_pHyprOpenGL->m_RenderData.pMonitor;
-	auto* workspace = g_pCompositor->getWorkspaceByID(this->workspace_id);
+	auto* context = g_Hy3Layout->getWorkspaceContext(this->workspace_id);
+	auto* workspace = context == nullptr ? nullptr : context->workspace;
 	auto scale = monitor->scale;
 
 	auto monitor_size = monitor->vecSize;
@@ -545,6 +1564,10 @@ void Hy3TabGroup::renderTabBar() {
 	    || scaled_pos.y + scaled_size.y < 0)
 		return;
 
+	// entries slide up to a bar height plus padding out of the bar when opening and closing
+	auto slide = (size.y + *padding) * scale;
+	CBox draw_box = {box.x, box.y - slide, box.width, box.height + slide * 2};
+
 	if (!this->bar.damaged) {
 		pixman_region32 damage;
 		pixman_region32_init(&damage);
@@ -552,10 +1575,10 @@ void Hy3TabGroup::renderTabBar() {
 		pixman_region32_intersect_rect(
 		    &damage,
 		    g_pHyprOpenGL->m_RenderData.damage.pixman(),
-		    box.x,
-		    box.y,
-		    box.width,
-		    box.height
+		    draw_box.x,
+		    draw_box.y,
+		    draw_box.width,
+		    draw_box.height
 		);
 
 		this->bar.damaged = pixman_region32_not_empty(&damage);
@@ -567,30 +1590,47 @@ void Hy3TabGroup::renderTabBar() {
 
 	this->bar.setSize(scaled_size);
 
-	{
-		glEnable(GL_STENCIL_TEST);
-		glClearStencil(0);
-		glClear(GL_STENCIL_BUFFER_BIT);
-		glStencilMask(0xff);
-		glStencilFunc(GL_ALWAYS, 1, 0xff);
-		glStencilOp(GL_KEEP, GL_KEEP, GL_REPLACE);
+	// The stencil is only written where windows overlap the bar, clipped to the bar, and
+	// only that area is cleared afterwards. The rest of the stencil is left untouched.
+	std::optional<CBox> stencil_box;
 
-		glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+	tab_batch.begin();
 
-		for (auto* window: this->stencil_windows) {
-			if (!g_pCompositor->windowExists(window)) continue;
+	for (auto* window: this->stencil_windows) {
+		auto wpos = window->m_vRealPosition.value() - monitor->vecPosition;
+		auto wsize = window->m_vRealSize.value();
 
-			auto wpos = window->m_vRealPosition.value() - monitor->vecPosition;
-			auto wsize = window->m_vRealSize.value();
+		CBox window_box = {wpos.x, wpos.y, wsize.x, wsize.y};
+		window_box.scale(scale);
 
-			CBox window_box = {wpos.x, wpos.y, wsize.x, wsize.y};
-			// scaleBox(&window_box, scale);
-			window_box.scale(scale);
+		if (window_box.width <= 0 || window_box.height <= 0 || !window_box.overlaps(draw_box))
+			continue;
 
-			if (window_box.width > 0 && window_box.height > 0)
-				g_pHyprOpenGL->renderRect(&window_box, CColor(0, 0, 0, 0), *window_rounding);
+		auto rounding = (double) *window_rounding;
+		tab_batch.add({.box = window_box, .color = CColor(0, 0, 0, 0), .rounding = rounding});
+
+		auto clipped = window_box.intersection(draw_box);
+
+		if (stencil_box) {
+			auto x2 = std::max(stencil_box->x + stencil_box->width, clipped.x + clipped.width);
+			auto y2 = std::max(stencil_box->y + stencil_box->height, clipped.y + clipped.height);
+			stencil_box->x = std::min(stencil_box->x, clipped.x);
+			stencil_box->y = std::min(stencil_box->y, clipped.y);
+			stencil_box->width = x2 - stencil_box->x;
+			stencil_box->height = y2 - stencil_box->y;
+		} else {
+			stencil_box = clipped;
 		}
+	}
 
+	if (stencil_box) {
+		glEnable(GL_STENCIL_TEST);
+		glStencilMask(0xff);
+		glStencilFunc(GL_ALWAYS, 1, 0xff);
+		glStencilOp(GL_KEEP, GL_KEEP, GL_REPLACE);
+
+		glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+		tab_batch.flush(draw_box);
 		glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
 
 		glStencilMask(0x00);
@@ -601,9 +1641,19 @@ void Hy3TabGroup::renderTabBar() {
 	auto fade_opacity =
 	    this->bar.fade_opacity.value() * (workspace == nullptr ? 1.0 : workspace->m_fAlpha.value());
 
+	auto scroll = this->bar.scroll.value();
+
 	auto render_entry = [&](Hy3TabBarEntry& entry) {
+		auto offset = entry.offset.value() - scroll;
+
+		// entries scrolled out of the strip do not keep their titles around
+		if (offset >= 1.0 || offset + entry.width.value() <= 0.0) {
+			entry.releaseTitles();
+			return;
+		}
+
 		Vector2D entry_pos = {
-		    (pos.x + (entry.offset.value() * size.x) + (*padding * 0.5)) * scale,
+		    (pos.x + (offset * size.x) + (*padding * 0.5)) * scale,
 		    scaled_pos.y
 		        + ((entry.vertical_pos.value() * (size.y + *padding) * scale)
 		           * (*enter_from_top ? -1 : 1)),
@@ -618,10 +1668,77 @@ void Hy3TabGroup::renderTabBar() {
 		    entry_size.y,
 		};
 
-		entry.prepareTexture(scale, box);
-		g_pHyprOpenGL->renderTexture(entry.texture, &box, fade_opacity * entry.fade_opacity.value());
+		auto opacity = fade_opacity * entry.fade_opacity.value();
+		auto focused = entry.focused.value();
+		auto urgent = entry.urgent.value();
+		auto inactive = 1.0 - (focused + urgent);
+
+		auto c = (CColor(*col_active) * focused) + (CColor(*col_urgent) * urgent)
+		       + (CColor(*col_inactive) * inactive);
+		c.a *= opacity;
+
+		auto rounding =
+		    std::min((double) *s_rounding * scale, std::min(box.width * 0.5, box.height * 0.5));
+		tab_batch.add({.box = box, .color = c, .rounding = rounding});
+
+		if (!*render_text) return;
+
+		// Fade between the cached title textures instead of rasterizing the blend.
+		// Text colors shared between states collapse into a single layer.
+		std::pair<Hy3TabTextColor, double> layers[] = {
+		    {Hy3TabTextColor::Inactive, std::max<double>(inactive, 0.0)},
+		    {Hy3TabTextColor::Active, std::max<double>(focused, 0.0)},
+		    {Hy3TabTextColor::Urgent, std::max<double>(urgent, 0.0)},
+		};
+
+		int64_t colors[] = {*col_text_inactive, *col_text_active, *col_text_urgent};
+
+		for (size_t i = 1; i < 3; i++) {
+			for (size_t j = 0; j < i; j++) {
+				if (colors[i] == colors[j]) {
+					layers[j].second += layers[i].second;
+					layers[i].second = 0.0;
+					break;
+				}
+			}
+		}
+
+		// heaviest first, so it is the layer drawn when layers cannot be added
+		std::sort(std::begin(layers), std::end(layers), [](auto& a, auto& b) {
+			return a.second > b.second;
+		});
+
+		// layers still rasterizing for the first time are left out of the blend
+		std::pair<Hy3TitleRegion*, double> regions[3];
+		size_t region_count = 0;
+		double total_weight = 0.0;
+
+		for (auto& [text_color, weight]: layers) {
+			if (weight <= 0.0) continue;
+
+			auto* region = entry.prepareTitle(scale, box, text_color);
+			if (region == nullptr) continue;
+
+			regions[region_count++] = {region, weight};
+			total_weight += weight;
+		}
+
+		for (size_t i = 0; i < region_count; i++) {
+			auto [region, weight] = regions[i];
+
+			tab_batch.add({
+			    .box = box,
+			    .color = CColor(1.0, 1.0, 1.0, opacity),
+			    .region = region,
+			    .weight = weight / total_weight,
+			    .additive = i != 0,
+			});
+		}
 	};
 
+	// focused entries are added last so they are drawn over the others
+	tab_batch.begin();
+
 	for (auto& entry: this->bar.entries) {
 		if (entry.focused.goal() == 1.0) continue;
 		render_entry(entry);
@@ -632,11 +1749,17 @@ void Hy3TabGroup::renderTabBar() {
 		render_entry(entry);
 	}
 
-	{
+	tab_batch.flush(draw_box);
+
+	if (stencil_box) {
+		// glClear honors the scissor and stencil mask
+		glStencilMask(0xff);
+		g_pHyprOpenGL->scissor(&*stencil_box);
 		glClearStencil(0);
 		glClear(GL_STENCIL_BUFFER_BIT);
+		g_pHyprOpenGL->scissor((CBox*) nullptr);
+
 		glDisable(GL_STENCIL_TEST);
-		glStencilMask(0xff);
 		glStencilFunc(GL_ALWAYS, 1, 0xff);
 	}
 }
@@ -671,3 +1794,66 @@ void Hy3TabGroup::updateStencilWindows(Hy3Node& group) {
 	this->stencil_windows.clear();
 	findOverlappingWindows(group, this->size.goal().y, this->stencil_windows);
 }
+
+bool Hy3TabGroup::isWorkspaceShown() {
+	auto* context = g_Hy3Layout->getWorkspaceContext(this->workspace_id);
+	if (context == nullptr || context->monitor == nullptr) return false;
+
+	auto* monitor = context->monitor;
+	return monitor->activeWorkspace == this->workspace_id
+	    || monitor->specialWorkspaceID == this->workspace_id;
+}
+
+bool Hy3TabGroup::isVisible() {
+	if (this->isWorkspaceShown()) return true;
+
+	auto* context = g_Hy3Layout->getWorkspaceContext(this->workspace_id);
+	if (context == nullptr || context->monitor == nullptr) return false;
+
+	auto* workspace = context->workspace;
+	return workspace->m_vRenderOffset.isBeingAnimated() || workspace->m_fAlpha.isBeingAnimated();
+}
+
+void Hy3TabGroup::suspend() {
+	// set first so the warps below do not queue the group again
+	this->suspended = true;
+
+	this->pos.warp();
+	this->size.warp();
+	this->bar.fade_opacity.warp();
+
+	for (auto& entry: this->bar.entries) {
+		entry.focused.warp();
+		entry.urgent.warp();
+		entry.offset.warp();
+		entry.width.warp();
+		entry.vertical_pos.warp();
+		entry.fade_opacity.warp();
+	}
+
+	// drops entries that finished closing, possibly destroying the bar
+	this->bar.tick();
+}
+
+void Hy3TabGroup::setTargetWindow(CWindow* window) {
+	if (this->target_window == window) return;
+	auto& targets = g_Hy3Layout->tab_group_targets;
+
+	if (this->target_window != nullptr) {
+		auto [begin, end] = targets.equal_range(this->target_window);
+		for (auto iter = begin; iter != end; iter++) {
+			if (iter->second == this) {
+				targets.erase(iter);
+				break;
+			}
+		}
+	}
+
+	this->target_window = window;
+	if (window != nullptr) targets.emplace(window, this);
+}
+
+void Hy3TabGroup::forgetWindow(CWindow* window) {
+	std::erase(this->stencil_windows, window);
+	if (this->target_window == window) this->setTargetWindow(nullptr);
+}
@@ -2,7 +2,11 @@
 
 class Hy3TabGroup;
 class Hy3TabBar;
+struct Hy3TitleRasterJob;
+struct Hy3TitleRegion;
+class Hy3TitleAtlas;
 
+#include <chrono>
 #include <list>
 #include <memory>
 #include <vector>
@@ -12,39 +16,121 @@ class Hy3TabBar;
 
 #include "Hy3Node.hpp"
 
+enum class Hy3TabTextColor {
+	Inactive,
+	Active,
+	Urgent,
+};
+
+// A float animated by its tab bar instead of registering a CAnimatedVariable, so entries
+// can be stored contiguously and cost no registrations. Mirrors the parts of
+// CAnimatedVariable the tab bar uses. Setting a new goal does not wake the bar, callers
+// are expected to.
+class Hy3TabAnimatedValue {
+public:
+	Hy3TabAnimatedValue(float value): current(value), begin(value), target(value) {}
+
+	float value() const { return this->current; }
+	float goal() const { return this->target; }
+
+	Hy3TabAnimatedValue& operator=(float goal) {
+		if (goal == this->target) return *this;
+
+		this->begin = this->current;
+		this->target = goal;
+		this->started = std::chrono::steady_clock::now();
+		this->animating = true;
+		return *this;
+	}
+
+	void setValueAndWarp(float value) {
+		this->current = this->target = value;
+		this->animating = false;
+	}
+
+	void warp() {
+		this->current = this->target;
+		this->animating = false;
+	}
+
+private:
+	float current;
+	float begin;
+	float target;
+	bool animating = false;
+	std::chrono::steady_clock::time_point started;
+
+	friend class Hy3TabBar;
+};
+
 struct Hy3TabBarEntry {
 	std::string window_title;
 	bool destroying = false;
-	CTexture texture;
-	CAnimatedVariable<float> focused;
-	CAnimatedVariable<float> urgent;
-	CAnimatedVariable<float> offset;       // 0.0-1.0 of total bar
-	CAnimatedVariable<float> width;        // 0.0-1.0 of total bar
-	CAnimatedVariable<float> vertical_pos; // 0.0-1.0, user specified direction
-	CAnimatedVariable<float> fade_opacity; // 0.0-1.0
-	Hy3TabBar& tab_bar;
-	Hy3Node& node; // only used for comparioson. do not deref.
-
-	struct {
-		int x, y;
-		float rounding = 0.0;
+	// set when the entry's drawn rect or contents changed since the last tick
+	bool dirty = true;
+	// the rect last damaged for this entry, in layout coordinates
+	CBox damage_box;
+	// The title rasterized in one text color.
+	// Titles are rasterized on a worker thread. Until a job finishes the previous raster,
+	// if any, keeps being drawn. Jobs are shared with the worker and cancelled, never
+	// waited on, when superseded or when the entry is destroyed.
+	// Rasters live in a region of the title atlas for their scale, freed with the entry.
+	struct TitleSlot {
+		Hy3TitleRegion* region = nullptr;
+		std::shared_ptr<Hy3TitleRasterJob> job;
+		// the last uploaded job, kept so its buffers can be reused
+		std::shared_ptr<Hy3TitleRasterJob> spare_job;
+		bool current = false;
+		bool redraw_requested = false;
+	};
+
+	// The title rasterized once per text color at one output scale, indexed by
+	// Hy3TabTextColor. Focus and urgency fades blend between them at draw time.
+	// A bar drawn on monitors of different scales keeps one set per scale, so moving
+	// between them does not rasterize again. Sets unused for a while are dropped.
+	struct ScaledTitles {
 		float scale = 0.0;
-		float focused = 0.0;
-		float urgent = 0.0;
-		std::string window_title;
-
-		std::string text_font;
-		int text_height = 0;
-		int text_padding = 0;
-		int col_active = 0;
-		int col_urgent = 0;
-		int col_inactive = 0;
-		int col_text_active = 0;
-		int col_text_urgent = 0;
-		int col_text_inactive = 0;
-	} last_render;
+		TitleSlot titles[3];
+		std::chrono::steady_clock::time_point last_used;
+
+		ScaledTitles() = default;
+		// releases the atlas regions and cancels the jobs of every title
+		~ScaledTitles();
+		ScaledTitles(const ScaledTitles&) = delete;
+
+		// everything else affecting the title textures' pixels. the position is deliberately
+		// not included as moving a tab only moves the quad it is drawn on.
+		struct {
+			double width = 0.0;
+			double height = 0.0;
+			std::string window_title;
+
+			std::string text_font;
+			int text_height = 0;
+			int text_padding = 0;
+			int text_center = 0;
+			int col_text_active = 0;
+			int col_text_urgent = 0;
+			int col_text_inactive = 0;
+		} last_render;
+	};
+
+	std::list<ScaledTitles> scaled_titles;
+	// animated by Hy3TabBar::stepAnimations
+	Hy3TabAnimatedValue focused = 0.0;      // fadeSwitch
+	Hy3TabAnimatedValue urgent = 0.0;       // fadeSwitch
+	Hy3TabAnimatedValue offset = -1.0;      // windowsMove, 0.0-1.0 of total bar
+	Hy3TabAnimatedValue width = -1.0;       // windowsMove, 0.0-1.0 of total bar
+	Hy3TabAnimatedValue vertical_pos = 1.0; // windowsIn, 0.0-1.0, user specified direction
+	Hy3TabAnimatedValue fade_opacity = 0.0; // windowsIn, 0.0-1.0
+	Hy3TabBar* tab_bar;
+	Hy3Node* node; // only used for comparioson. do not deref.
 
 	Hy3TabBarEntry(Hy3TabBar&, Hy3Node&);
+	// entries live in a vector and are moved when it changes, their titles go with them.
+	Hy3TabBarEntry(Hy3TabBarEntry&&) = default;
+	Hy3TabBarEntry& operator=(Hy3TabBarEntry&&) = default;
+	Hy3TabBarEntry(const Hy3TabBarEntry&) = delete;
 	bool operator==(const Hy3Node&) const;
 	bool operator==(const Hy3TabBarEntry&) const;
 
@@ -54,25 +140,52 @@ struct Hy3TabBarEntry {
 	void beginDestroy();
 	void unDestroy();
 	bool shouldRemove();
-	void prepareTexture(float, CBox&);
+	// damage the rect last drawn for the entry, as it will not be visited again once removed
+	void damageLastBox();
+	// Returns the atlas region of the title to draw for the given text color, or nullptr if
+	// none is ready yet. Starts rasterizing the title in the background if it is out of date.
+	Hy3TitleRegion* prepareTitle(float scale, CBox& box, Hy3TabTextColor color);
+	// returns true once for every title raster that finished since the last call.
+	bool takeFinishedTitles();
+	// returns true while any title raster has not been taken by takeFinishedTitles.
+	bool hasPendingTitles();
+	// drop every title raster, for entries scrolled out of view.
+	void releaseTitles();
 };
 
+// stop the title rasterization workers for good, abandoning queued and later jobs.
+void stopTitleRasterizer();
+// free the GL resources used to draw tab bars in one batch.
+void destroyTabBatch();
+
 class Hy3TabBar {
 public:
 	bool destroy = false;
 	bool dirty = true;
 	bool damaged = true;
+	// set by tick while titles are still being rasterized or entries are animating
+	bool titles_pending = false;
+	bool animating = false;
 	CAnimatedVariable<float> fade_opacity;
+	// Horizontal scroll of the tab strip, as a fraction of the bar width. Only non-zero when
+	// tabs:min_width makes the entries wider than the bar, then follows the focused entry.
+	CAnimatedVariable<float> scroll;
+	Hy3TabGroup& group;
 
-	Hy3TabBar();
+	Hy3TabBar(Hy3TabGroup&);
 	void beginDestroy();
+	// have the owning group ticked, for changes not driven by its animations
+	void wake();
 
 	void tick();
+	// Advance the animated values of every entry, marking changed entries dirty. The
+	// animation configs are resolved once for all bars. Returns true while any animates.
+	bool stepAnimations();
 	void updateNodeList(std::list<Hy3Node*>& nodes);
 	void updateAnimations(bool warp = false);
 	void setSize(Vector2D);
 
-	std::list<Hy3TabBarEntry> entries;
+	std::vector<Hy3TabBarEntry> entries;
 
 private:
 	Hy3Node* focused_node = nullptr;
@@ -85,9 +198,20 @@ private:
 
 class Hy3TabGroup {
 public:
+	// only set through setTargetWindow
 	CWindow* target_window = nullptr;
 	int workspace_id = -1;
 	bool hidden = false;
+	// the render hook's frame serial when this bar was last drawn
+	uint64_t rendered_frame = 0;
+	// queued for the next layout tick. woken by the update callbacks of the group's pos and
+	// size and the bar's fade_opacity and scroll, and by Hy3TabBar::wake when entries change.
+	// entry values are stepped by the tick itself, so idle groups are never visited.
+	bool ticking = false;
+	// Set while the group's workspace is not shown on any monitor. Suspended groups have
+	// their animations snapped and are not ticked, updated or drawn. They are resumed with
+	// warped state by the next update once their workspace is visible again.
+	bool suspended = false;
 	Hy3TabBar bar;
 	CAnimatedVariable<Vector2D> pos;
 	CAnimatedVariable<Vector2D> size;
@@ -97,9 +221,19 @@ public:
 
 	// update tab bar with node position and data. UB if node is not a group.
 	void updateWithGroup(Hy3Node&, bool warp);
-	void tick();
+	// returns true if the group needs another tick, while titles rasterize, entries animate
+	// or its workspace is animating out.
+	bool tick();
+	// set the window this bar is drawn after, updating the layout's lookup table.
+	void setTargetWindow(CWindow*);
+	// true if the group's workspace is shown, or still animating out, on a monitor.
+	bool isVisible();
+	// true if the group's workspace is shown on a monitor, ignoring its animations.
+	bool isWorkspaceShown();
 	// render the scaled tab bar on the current monitor.
 	void renderTabBar();
+	// drop all references to a window that is about to be unmapped.
+	void forgetWindow(CWindow*);
 
 private:
 	std::vector<CWindow*> stencil_windows;
@@ -113,4 +247,6 @@ private:
 
 	// UB if node is not a group.
 	void updateStencilWindows(Hy3Node&);
+	// snap all animations and stop ticking until resumed by updateWithGroup.
+	void suspend();
 };
@@ -233,6 +233,13 @@ void dispatch_expand(std::string value) {
 	g_Hy3Layout->expand(workspace, expand, fs_expand);
 }
 
+void dispatch_compact(std::string value) {
+	int workspace = workspace_for_action();
+	if (workspace == -1) return;
+
+	g_Hy3Layout->compactWorkspace(workspace);
+}
+
 void dispatch_debug(std::string arg) {
 	int workspace = workspace_for_action();
 	if (workspace == -1) return;
@@ -257,5 +264,6 @@ void registerDispatchers() {
 	HyprlandAPI::addDispatcher(PHANDLE, "hy3:setswallow", dispatch_setswallow);
 	HyprlandAPI::addDispatcher(PHANDLE, "hy3:killactive", dispatch_killactive);
 	HyprlandAPI::addDispatcher(PHANDLE, "hy3:expand", dispatch_expand);
+	HyprlandAPI::addDispatcher(PHANDLE, "hy3:compact", dispatch_compact);
 	HyprlandAPI::addDispatcher(PHANDLE, "hy3:debugnodes", dispatch_debug);
 }
@@ -38,10 +38,13 @@ APICALL EXPORT PLUGIN_DESCRIPTION_INFO PLUGIN_INIT(HANDLE handle) {
 	CONF("node_collapse_policy", INT, 2);
 	CONF("group_inset", INT, 10);
 	CONF("tab_first_window", INT, 0);
+	CONF("size_hints", INT, 1);
+	CONF("auto_compact", INT, 0);
 
 	// tabs
 	CONF("tabs:height", INT, 15);
 	CONF("tabs:padding", INT, 5);
+	CONF("tabs:min_width", INT, 0);
 	CONF("tabs:from_top", INT, 0);
 	CONF("tabs:rounding", INT, 3);
 	CONF("tabs:render_text", INT, 1);
@@ -49,6 +52,7 @@ APICALL EXPORT PLUGIN_DESCRIPTION_INFO PLUGIN_INIT(HANDLE handle) {
 	CONF("tabs:text_font", STRING, "Sans");
 	CONF("tabs:text_height", INT, 8);
 	CONF("tabs:text_padding", INT, 3);
+	CONF("tabs:title_rate", INT, 0);
 	CONF("tabs:col.active", INT, 0xff32b4ff);
 	CONF("tabs:col.urgent", INT, 0xffff4f4f);
 	CONF("tabs:col.inactive", INT, 0x80808080);
@@ -63,6 +67,10 @@ APICALL EXPORT PLUGIN_DESCRIPTION_INFO PLUGIN_INIT(HANDLE handle) {
 	CONF("autotile:trigger_width", INT, 0);
 	CONF("autotile:workspaces", STRING, "all");
 
+	// transactions
+	CONF("transactions:enable", INT, 0);
+	CONF("transactions:timeout", INT, 200);
+
 #undef CONF
 
 	g_Hy3Layout = std::make_unique<Hy3Layout>();
@@ -75,4 +83,7 @@ APICALL EXPORT PLUGIN_DESCRIPTION_INFO PLUGIN_INIT(HANDLE handle) {
 	return {"hy3", "i3 like layout for hyprland", "outfoxxed", "0.1"};
 }
 
-APICALL EXPORT void PLUGIN_EXIT() {}
+APICALL EXPORT void PLUGIN_EXIT() {
+	stopTitleRasterizer();
+	destroyTabBatch();
+}